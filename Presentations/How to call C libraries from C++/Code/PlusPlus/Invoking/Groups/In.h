@@ -100,7 +100,7 @@ namespace PlusPlus
                : parameters( std::move( p ) )
                {}
             
-            TupleToPass PassedParts() const                 { return std::move( parameters ); }
+            TupleToPass PassedParts()                       { return std::move( parameters ); }
             
             bool CheckForFailure() const                    { return false; }
             
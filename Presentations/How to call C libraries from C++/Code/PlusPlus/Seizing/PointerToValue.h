@@ -58,7 +58,7 @@ namespace PlusPlus
             explicit operator bool() const                                              { return !( value == ValueType() ); }
            
             const ValueType& operator*() const                                          { return value; }
-            const ValueType *operator->() const                                         { return value; }
+            const ValueType *operator->() const                                         { return &value; }
            
             friend bool operator==( const PointerToValue& a, const PointerToValue& b )  { return *a == *b; }
             friend bool operator!=( const PointerToValue& a, const PointerToValue& b )  { return !( a == b ); }
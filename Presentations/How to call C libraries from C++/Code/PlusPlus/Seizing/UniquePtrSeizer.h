@@ -10,6 +10,7 @@
 #define PLUSPLUS_UNIQUEPTRSEIZER_H
 
 #include "PointerToValue.h"
+#include "UniquePtrToValue.h"
 
 #include <memory>
 
@@ -25,7 +26,7 @@
 namespace PlusPlus
    {
     template < class UniquePtrType, class PointerType = typename UniquePtrType::pointer >
-    class UniquePtrSeizer
+    struct UniquePtrSeizer
        {
         using Seized   = UniquePtrType;
         using Released = typename Seized::pointer;
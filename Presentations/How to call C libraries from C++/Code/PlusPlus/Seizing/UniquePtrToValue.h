@@ -0,0 +1,166 @@
+//
+//  UniquePtrToValue.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PLUSPLUS_UNIQUEPTRTOVALUE_H
+#define PLUSPLUS_UNIQUEPTRTOVALUE_H
+
+#include "PointerToValue.h"
+#include "Boxed.h"
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+/*
+    UniquePtrToValue< T, D > is std::unique_ptr< T, D >, written out so that operator* refers to the
+    pointer the unique_ptr holds.
+
+    A standard library may implement unique_ptr::operator* as *get().  That's fine for an ordinary pointer,
+    but get() returns a copy of the pointer, and when the pointer is a PointerToValue, *get() refers to the
+    value inside that temporary copy.  The reference dangles as soon as operator* returns, so *socket
+    reads whatever the stack holds by then.  (libstdc++ does this; libc++ doesn't.)
+
+    The standard allows a program to specialize std::unique_ptr for its own types, so the specializations
+    at the bottom of this file make every std::unique_ptr< const Boxed<Tag>, D > a UniquePtrToValue.
+    Code keeps using std::unique_ptr, and *socket refers to the value held by the socket's unique_ptr, as
+    it would with any pointer.  A header that makes unique_ptrs to another value type can add a similar
+    specialization for it.
+
+    The deleter is a base class of the stored pointer's holder, so an empty deleter takes no space:
+    a unique_ptr to a descriptor is the size of the descriptor.
+*/
+
+namespace PlusPlus
+   {
+    template < class T, class D >
+    struct UniquePtrToValuePointer
+       {
+        private:
+            template < class E > static typename E::pointer Test( typename E::pointer * );
+            template < class E > static T *Test( ... );
+
+        public:
+            using type = decltype( Test< D >( nullptr ) );
+       };
+
+    template < class T, class D >
+    class UniquePtrToValue
+       {
+        static_assert( !std::is_reference< D >::value, "UniquePtrToValue needs a deleter that isn't a reference" );
+        static_assert( !std::is_array< T >::value,     "UniquePtrToValue doesn't handle arrays" );
+
+        public:
+            using pointer      = typename UniquePtrToValuePointer< T, D >::type;
+            using element_type = T;
+            using deleter_type = D;
+
+        private:
+            struct Holder: D
+               {
+                pointer held;
+
+                Holder( pointer p, D&& d )                      : D( std::move( d ) ), held( std::move( p ) ) {}
+               };
+
+            Holder holder;
+
+            template < class U, class E >
+            using Converts = typename std::enable_if<    std::is_convertible< typename std::unique_ptr< U, E >::pointer, pointer >::value
+                                                      && !std::is_array< U >::value
+                                                      && std::is_convertible< E, D >::value >::type;
+
+        public:
+            UniquePtrToValue() noexcept                                     : holder( pointer(), D() ) {}
+            UniquePtrToValue( std::nullptr_t ) noexcept                     : holder( pointer(), D() ) {}
+            explicit UniquePtrToValue( pointer p ) noexcept                 : holder( std::move( p ), D() ) {}
+            UniquePtrToValue( pointer p, const D& d ) noexcept              : holder( std::move( p ), D( d ) ) {}
+            UniquePtrToValue( pointer p, D&& d ) noexcept                   : holder( std::move( p ), std::move( d ) ) {}
+
+            UniquePtrToValue( UniquePtrToValue&& u ) noexcept               : holder( u.release(), std::move( u.get_deleter() ) ) {}
+
+            template < class U, class E, class = Converts< U, E > >
+            UniquePtrToValue( std::unique_ptr< U, E >&& u ) noexcept        : holder( u.release(), D( std::move( u.get_deleter() ) ) ) {}
+
+            UniquePtrToValue( const UniquePtrToValue& )                     = delete;
+            UniquePtrToValue& operator=( const UniquePtrToValue& )          = delete;
+
+            ~UniquePtrToValue()
+               {
+                if ( holder.held )
+                    get_deleter()( std::move( holder.held ) );
+               }
+
+            UniquePtrToValue& operator=( UniquePtrToValue&& u ) noexcept
+               {
+                reset( u.release() );
+                get_deleter() = std::move( u.get_deleter() );
+                return *this;
+               }
+
+            template < class U, class E, class = Converts< U, E > >
+            UniquePtrToValue& operator=( std::unique_ptr< U, E >&& u ) noexcept
+               {
+                reset( u.release() );
+                get_deleter() = D( std::move( u.get_deleter() ) );
+                return *this;
+               }
+
+            UniquePtrToValue& operator=( std::nullptr_t ) noexcept
+               {
+                reset();
+                return *this;
+               }
+
+            typename std::add_lvalue_reference< T >::type operator*() const { return *holder.held; }
+            const pointer& operator->() const noexcept                      { return holder.held; }
+
+            pointer get() const noexcept                                    { return holder.held; }
+            D& get_deleter() noexcept                                       { return holder; }
+            const D& get_deleter() const noexcept                           { return holder; }
+
+            explicit operator bool() const noexcept                         { return static_cast< bool >( holder.held ); }
+
+            pointer release() noexcept
+               {
+                pointer result = std::move( holder.held );
+                holder.held = pointer();
+                return result;
+               }
+
+            void reset( pointer p = pointer() ) noexcept
+               {
+                pointer old = std::move( holder.held );
+                holder.held = std::move( p );
+
+                if ( old )
+                    get_deleter()( std::move( old ) );
+               }
+
+            void swap( UniquePtrToValue& u ) noexcept
+               {
+                using std::swap;
+                swap( holder.held, u.holder.held );
+                swap( get_deleter(), u.get_deleter() );
+               }
+       };
+   }
+
+namespace std
+   {
+    template < class Tag, class D >
+    class unique_ptr< const PlusPlus_Boxed::Boxed< Tag >, D >: public PlusPlus::UniquePtrToValue< const PlusPlus_Boxed::Boxed< Tag >, D >
+       {
+        public:
+            using PlusPlus::UniquePtrToValue< const PlusPlus_Boxed::Boxed< Tag >, D >::UniquePtrToValue;
+            using PlusPlus::UniquePtrToValue< const PlusPlus_Boxed::Boxed< Tag >, D >::operator=;
+
+            unique_ptr() noexcept = default;
+       };
+   }
+
+#endif
@@ -50,7 +50,7 @@ namespace PlusPlus
         template < class E, std::size_t n >    E const *arraylike_data( const std::array<E,n>& a )              { return a.data(); };
         template < class E, class A >          E       *arraylike_data(       std::vector<E,A>& a )             { return a.data(); };
         template < class E, class A >          E const *arraylike_data( const std::vector<E,A>& a )             { return a.data(); };
-        template < class C, class T, class A > C       *arraylike_data(       std::basic_string<C,T,A>& a )     { return a.data(); };
+        template < class C, class T, class A > C       *arraylike_data(       std::basic_string<C,T,A>& a )     { return &a[0]; };      // data() is const until C++17
         template < class C, class T, class A > C const *arraylike_data( const std::basic_string<C,T,A>& a )     { return a.data(); };
 
 
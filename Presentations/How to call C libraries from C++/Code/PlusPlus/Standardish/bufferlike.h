@@ -11,23 +11,37 @@
 
 #include "arraylike.h"
 #include "charlike.h"
+#include "integer_sequence.h"
 
 #include <type_traits>
+#include <tuple>
 
 /*
     is_bufferlike       detects types that can be treated as an array of characters for bytewise I/O.
     bufferlike_data     provides a uniform interface to the start of the buffer.
     bufferlike_size     provides a uniform interface to the size of the buffer.
+    
+    is_buffer_sequence      detects sequences of buffers, for scatter/gather I/O: tuples of bufferlike types 
+                            (or references to them), and arraylike types whose elements are bufferlike.
+    buffer_sequence_extent  is the number of buffers in a sequence of fixed size (a tuple or an array), 
+                            and zero for a sequence sized at run time, like a vector.  Compare std::extent.
+    buffer_sequence_size    provides a uniform interface to the number of buffers in a sequence.
+    for_each_buffer         calls f( data, size ) for each buffer in a sequence, in order.
 */
     
 namespace PlusPlus
    {
     namespace stdish
        {
+        // arraylike_element is only examined for arraylike types, so is_bufferlike is false, not an error, for the rest.
+        template < class T, bool arraylike = PlusPlus::stdish::is_arraylike<T>::value >
+        struct is_bufferlike_trait: std::false_type {};
+        
         template < class T >
-        using is_bufferlike
-            = std::integral_constant< bool, PlusPlus::stdish::is_arraylike<T>::value 
-                                            && PlusPlus::stdish::is_charlike< PlusPlus::stdish::arraylike_element<T> >::value >;
+        struct is_bufferlike_trait< T, true >: PlusPlus::stdish::is_charlike< PlusPlus::stdish::arraylike_element<T> > {};
+        
+        template < class T >
+        using is_bufferlike = is_bufferlike_trait<T>;
         
         
         
@@ -62,6 +76,75 @@ namespace PlusPlus
             
             return arraylike_size( b ) * sizeof( arraylike_element<B> );
            }
+
+
+
+        template < bool... > struct all_true;
+        
+        template <>                            struct all_true<>:             std::true_type {};
+        template < bool first, bool... rest >  struct all_true< first, rest... >: std::integral_constant< bool, first && all_true< rest... >::value > {};
+
+
+
+        template < class T, bool arraylike = is_arraylike<T>::value > struct is_buffer_sequence;
+        
+        template < class T >       struct is_buffer_sequence< T, true >:                   is_bufferlike< arraylike_element<T> > {};
+        template < class T >       struct is_buffer_sequence< T, false >:                  std::false_type {};
+        template < class... B >    struct is_buffer_sequence< std::tuple<B...>, false >:   all_true< is_bufferlike< typename std::remove_cv< typename std::remove_reference<B>::type >::type >::value... > {};
+        
+        
+        
+        template < class T >                    struct buffer_sequence_extent:                        std::integral_constant< std::size_t, 0 >            {};
+        template < class E, std::size_t n >     struct buffer_sequence_extent< E[n] >:                std::integral_constant< std::size_t, n >            {};
+        template < class E, std::size_t n >     struct buffer_sequence_extent< std::array<E,n> >:     std::integral_constant< std::size_t, n >            {};
+        template < class... B >                 struct buffer_sequence_extent< std::tuple<B...> >:    std::integral_constant< std::size_t, sizeof...(B) > {};
+        
+        
+        
+        template < class... B >
+        std::size_t buffer_sequence_size( const std::tuple<B...>& )
+           {
+            return sizeof...(B);
+           }
+        
+        template < class S >
+        auto buffer_sequence_size( const S& s )
+        -> typename std::enable_if< is_buffer_sequence<S>::value && is_arraylike<S>::value, std::size_t >::type
+           {
+            return arraylike_size( s );
+           }
+        
+        
+        
+        template < class Tuple, class F, std::size_t... indices >
+        void for_each_buffer_in_tuple( Tuple& t, F& f, index_sequence< indices... > )
+           {
+            // The braced list guarantees the buffers are visited in order.
+            int inOrder[] = { 0, ( f( bufferlike_data( std::get<indices>( t ) ), bufferlike_size( std::get<indices>( t ) ) ), 0 )... };
+            (void)inOrder;
+           }
+        
+        template < class... B, class F >
+        void for_each_buffer( std::tuple<B...>& t, F f )
+           {
+            for_each_buffer_in_tuple( t, f, index_sequence_for< B... >() );
+           }
+        
+        template < class... B, class F >
+        void for_each_buffer( const std::tuple<B...>& t, F f )
+           {
+            for_each_buffer_in_tuple( t, f, index_sequence_for< B... >() );
+           }
+        
+        template < class S, class F >
+        auto for_each_buffer( S& s, F f )
+        -> typename std::enable_if< is_buffer_sequence< typename std::remove_const<S>::type >::value
+                                    && is_arraylike< typename std::remove_const<S>::type >::value >::type
+           {
+            auto *buffers = arraylike_data( s );
+            for ( std::size_t i = 0, n = arraylike_size( s ); i < n; ++i )
+                f( bufferlike_data( buffers[i] ), bufferlike_size( buffers[i] ) );
+           }
        }
    }
 
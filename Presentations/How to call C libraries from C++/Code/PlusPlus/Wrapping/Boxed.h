@@ -9,6 +9,7 @@
 #ifndef PLUSPLUS_BOXED_H
 #define PLUSPLUS_BOXED_H
 
+#include <type_traits>
 #include <utility>
 #include <iosfwd>
 
@@ -60,11 +61,12 @@ namespace PlusPlus_Boxed
         
             explicit constexpr Boxed( ValueType c )         : contents( std::move( c ) ) {}
         
-            template < class OtherTag >
-            constexpr Boxed( const Boxed< OtherTag >& b )   : contents( b.Get() )               { static_assert( std::is_convertible< OtherTag, Tag >::value, "Boxed types only convert when their tags do." ); }
+            // Boxed types only convert when their tags do.  The constraint keeps other conversions out of overload resolution.
+            template < class OtherTag, class = typename std::enable_if< std::is_convertible< OtherTag, Tag >::value >::type >
+            constexpr Boxed( const Boxed< OtherTag >& b )   : contents( b.Get() )               {}
 
-            template < class OtherTag >
-            constexpr Boxed( Boxed< OtherTag >&& b )        : contents( std::move(b).Get() )    { static_assert( std::is_convertible< OtherTag, Tag >::value, "Boxed types only convert when their tags do." ); }
+            template < class OtherTag, class = typename std::enable_if< std::is_convertible< OtherTag, Tag >::value >::type >
+            constexpr Boxed( Boxed< OtherTag >&& b )        : contents( std::move(b).Get() )    {}
            
             ValueType&  Get() &                             { return contents; }
             ValueType&& Get() &&                            { return std::move( contents ); }
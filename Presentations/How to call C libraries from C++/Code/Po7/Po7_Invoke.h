@@ -14,17 +14,32 @@
 #include "Invoke.h"
 #include "GroupMakers.h"
 
+#include <cerrno>
+#include <system_error>
+#include <type_traits>
+
 namespace Po7
    {
     template < class T > struct Forwarder: PlusPlus::ForwardOutputsAndNonscalarsAsPointers<T> {};
     
     
     
+    class ReportErrorFromErrno;
+    
+    template < class... P > struct IncludesErrorReport: std::false_type {};
+    
+    template < class First, class... More >
+    struct IncludesErrorReport< First, More... >
+       : std::integral_constant< bool, std::is_same< typename std::decay<First>::type, ReportErrorFromErrno >::value
+                                       || IncludesErrorReport< More... >::value >
+       {};
+    
     template < class R, class F, class... P >
     auto Invoke( R&& r, F&& f, P&&... p )
-    -> decltype( PlusPlus::Invoke< Wrapper, Seizer, Forwarder >( std::forward<R>(r),
-                                                                 std::forward<F>(f),
-                                                                 std::forward<P>(p)... ) )
+    -> typename std::enable_if< !IncludesErrorReport< P... >::value,
+                                decltype( PlusPlus::Invoke< Wrapper, Seizer, Forwarder >( std::forward<R>(r),
+                                                                                          std::forward<F>(f),
+                                                                                          std::forward<P>(p)... ) ) >::type
        {
         return   PlusPlus::Invoke< Wrapper, Seizer, Forwarder >( std::forward<R>(r),
                                                                  std::forward<F>(f),
@@ -39,6 +54,12 @@ namespace Po7
         return std::system_error( Wrap< std::error_code >( errno ) );
        }
     
+    // ErrnoIsWouldBlock recognizes the errors a non-blocking call reports when it isn't ready.
+    inline bool ErrnoIsWouldBlock()
+       {
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+       }
+    
     struct ThrowErrorFromErrno
        {
         std::tuple<> PassedParts() const                    { return std::tuple<>(); }
@@ -54,6 +75,87 @@ namespace Po7
         std::tuple< std::system_error > ThrownParts() const { return std::make_tuple( MakeSystemErrorFromErrno() ); }
         std::tuple<> ReturnedParts() const                  { return std::tuple<>(); }
        };
+
+    
+    // ReportErrorFromErrno is the non-throwing counterpart of ThrowErrorFromErrno.  Put in its place, it makes
+    // Invoke store the error in a std::error_code and return a default-constructed result when the result group
+    // reports failure, and clear the error_code on success.  Failures found by parameter groups, or while
+    // wrapping, are still thrown.
+    class ReportErrorFromErrno
+       {
+        private:
+            std::error_code *destination;
+        
+        public:
+            explicit ReportErrorFromErrno( std::error_code& e ) : destination( &e ) {}
+            
+            std::error_code& Destination() const                { return *destination; }
+            
+            std::tuple<> PassedParts() const                    { return std::tuple<>(); }
+            bool CheckForFailure() const                        { return false; }
+            std::tuple<> ThrownParts() const                    { return std::tuple<>(); }
+            std::tuple<> ReturnedParts() const                  { return std::tuple<>(); }
+       };
+    
+    // ErrorReportingResult wraps the result group of an Invoke that includes ReportErrorFromErrno.
+    // It checks the result while errno is fresh, and never fails.
+    template < class ResultGroup >
+    class ErrorReportingResult
+       {
+        private:
+            ResultGroup group;
+            std::error_code *destination;
+            
+        public:
+            using ResultType = typename ResultGroup::ResultType;
+            using Returned   = decltype( std::declval< ResultGroup& >().ReturnedParts( std::declval< ResultType& >() ) );
+            
+            ErrorReportingResult( ResultGroup g, std::error_code& e )
+               : group( std::move( g ) ),
+                 destination( &e )
+               {}
+            
+            bool CheckForFailure( const ResultType& ) const     { return false; }
+            std::tuple<> ThrownParts( ResultType& ) const       { return std::tuple<>(); }
+            
+            Returned ReturnedParts( ResultType& r )
+               {
+                if ( group.CheckForFailure( r ) )
+                   {
+                    *destination = Wrap< std::error_code >( errno );
+                    return Returned();
+                   }
+                
+                destination->clear();
+                return group.ReturnedParts( r );
+               }
+       };
+    
+    template < class... More >
+    std::error_code& ErrorDestination( const ReportErrorFromErrno& report, const More&... )
+       {
+        return report.Destination();
+       }
+    
+    template < class First, class... More >
+    std::error_code& ErrorDestination( const First&, const More&... more )
+       {
+        return ErrorDestination( more... );
+       }
+    
+    template < class R, class F, class... P >
+    auto Invoke( R&& r, F&& f, P&&... p )
+    -> typename std::enable_if< IncludesErrorReport< P... >::value,
+                                decltype( PlusPlus::Invoke< Wrapper, Seizer, Forwarder >( std::declval< ErrorReportingResult< typename std::decay<R>::type > >(),
+                                                                                          std::forward<F>(f),
+                                                                                          std::forward<P>(p)... ) ) >::type
+       {
+        using ReportingGroup = ErrorReportingResult< typename std::decay<R>::type >;
+        
+        return   PlusPlus::Invoke< Wrapper, Seizer, Forwarder >( ReportingGroup( std::forward<R>(r), ErrorDestination( p... ) ),
+                                                                 std::forward<F>(f),
+                                                                 std::forward<P>(p)... );
+       }
    }
 
 #endif
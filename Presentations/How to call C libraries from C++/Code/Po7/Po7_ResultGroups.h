@@ -0,0 +1,126 @@
+//
+//  Po7_ResultGroups.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_RESULTGROUPS_H
+#define PO7_RESULTGROUPS_H
+
+#include "Po7_Invoke.h"
+#include "Po7_socket.h"
+
+#include <cstddef>
+#include <tuple>
+
+#include <sys/types.h>
+
+namespace Po7
+   {
+    // These are the result groups the Po7 implementation files share, named for the C return type and for
+    // what's made of it.  A "Try" group treats EAGAIN as success, for non-blocking descriptors.
+    //
+    // They're for the implementation; the headers that declare Po7's interface don't include this one.
+
+    // ssize_t_Result returns a byte count; -1 is failure.
+        struct ssize_t_Result
+           {
+            using ResultType                                                    = ::ssize_t;
+            bool CheckForFailure( ::ssize_t s ) const                           { return s == -1; }
+            std::tuple<> ThrownParts( ::ssize_t ) const                         { return std::tuple<>(); }
+            std::tuple< std::size_t > ReturnedParts( ::ssize_t s ) const        { return std::make_tuple( static_cast<std::size_t>( s ) ); }
+           };
+
+    // ssize_t_TryResult returns a try_result: a byte count, or a note that the call would block.
+        struct ssize_t_TryResult
+           {
+            using ResultType                                                    = ::ssize_t;
+            bool CheckForFailure( ::ssize_t s ) const                           { return s == -1 && !ErrnoIsWouldBlock(); }
+            std::tuple<> ThrownParts( ::ssize_t ) const                         { return std::tuple<>(); }
+            std::tuple< try_result > ReturnedParts( ::ssize_t s ) const         { return std::make_tuple( s == -1 ? try_result()
+                                                                                                                  : try_result( static_cast<std::size_t>( s ) ) ); }
+           };
+
+    // ssize_t_FlagResult and ssize_t_TryFlagResult return nothing; they're for reads of a fixed size.
+        struct ssize_t_FlagResult
+           {
+            using ResultType                                                    = ::ssize_t;
+            bool CheckForFailure( ::ssize_t s ) const                           { return s == -1; }
+            std::tuple<> ThrownParts( ::ssize_t ) const                         { return std::tuple<>(); }
+            std::tuple<> ReturnedParts( ::ssize_t ) const                       { return std::tuple<>(); }
+           };
+
+        struct ssize_t_TryFlagResult
+           {
+            using ResultType                                                    = ::ssize_t;
+            bool CheckForFailure( ::ssize_t s ) const                           { return s == -1 && !ErrnoIsWouldBlock(); }
+            std::tuple<> ThrownParts( ::ssize_t ) const                         { return std::tuple<>(); }
+            std::tuple<> ReturnedParts( ::ssize_t ) const                       { return std::tuple<>(); }
+           };
+
+    // ssize_t_ReadyResult says whether the call did anything, rather than blocking.
+        struct ssize_t_ReadyResult
+           {
+            using ResultType                                                    = ::ssize_t;
+            bool CheckForFailure( ::ssize_t s ) const                           { return s == -1 && !ErrnoIsWouldBlock(); }
+            std::tuple<> ThrownParts( ::ssize_t ) const                         { return std::tuple<>(); }
+            std::tuple< bool > ReturnedParts( ::ssize_t s ) const               { return std::make_tuple( s != -1 ); }
+           };
+
+    // int_CountResult returns a count of things; int_TryCountResult returns zero when the call would block.
+        struct int_CountResult
+           {
+            using ResultType                                                    = int;
+            bool CheckForFailure( int n ) const                                 { return n == -1; }
+            std::tuple<> ThrownParts( int ) const                               { return std::tuple<>(); }
+            std::tuple< std::size_t > ReturnedParts( int n ) const              { return std::make_tuple( static_cast<std::size_t>( n ) ); }
+           };
+
+    // int_InterruptibleCountResult counts too, but a call interrupted by a signal counts zero things,
+    // for waits that a caller would simply repeat.
+        struct int_InterruptibleCountResult
+           {
+            using ResultType                                                    = int;
+            bool CheckForFailure( int n ) const                                 { return n == -1 && errno != EINTR; }
+            std::tuple<> ThrownParts( int ) const                               { return std::tuple<>(); }
+            std::tuple< std::size_t > ReturnedParts( int n ) const              { return std::make_tuple( n == -1 ? std::size_t( 0 ) : static_cast<std::size_t>( n ) ); }
+           };
+
+        struct int_TryCountResult
+           {
+            using ResultType                                                    = int;
+            bool CheckForFailure( int n ) const                                 { return n == -1 && !ErrnoIsWouldBlock(); }
+            std::tuple<> ThrownParts( int ) const                               { return std::tuple<>(); }
+            std::tuple< std::size_t > ReturnedParts( int n ) const              { return std::make_tuple( n == -1 ? std::size_t( 0 ) : static_cast<std::size_t>( n ) ); }
+           };
+
+    // int_FlagResult is FailureFlagResult<int> for calls that fail with -1 but may succeed with other
+    // values than zero; int_TryFlagResult also lets EAGAIN pass.
+        struct int_FlagResult
+           {
+            using ResultType                                                    = int;
+            bool CheckForFailure( int r ) const                                 { return r == -1; }
+            std::tuple<> ThrownParts( int ) const                               { return std::tuple<>(); }
+            std::tuple<> ReturnedParts( int ) const                             { return std::tuple<>(); }
+           };
+
+        struct int_TryFlagResult
+           {
+            using ResultType                                                    = int;
+            bool CheckForFailure( int r ) const                                 { return r == -1 && !ErrnoIsWouldBlock(); }
+            std::tuple<> ThrownParts( int ) const                               { return std::tuple<>(); }
+            std::tuple<> ReturnedParts( int ) const                             { return std::tuple<>(); }
+           };
+
+    // pthread functions return their error numbers rather than setting errno.
+        struct int_ErrorNumberResult
+           {
+            using ResultType                                                    = int;
+            bool CheckForFailure( int r ) const                                 { return r != 0; }
+            std::tuple< std::system_error > ThrownParts( int r ) const          { return std::make_tuple( std::system_error( Wrap< std::error_code >( r ) ) ); }
+            std::tuple<> ReturnedParts( int ) const                             { return std::tuple<>(); }
+           };
+   }
+
+#endif
@@ -0,0 +1,166 @@
+//
+//  Po7_chunked_reader.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_chunked_reader.h"
+#include "Po7_Invoke.h"
+
+#include <algorithm>
+#include <system_error>
+#include <thread>
+
+#include <sys/stat.h>
+
+namespace
+   {
+    std::size_t PageSize()
+       {
+        static const std::size_t size = static_cast< std::size_t >( ::sysconf( _SC_PAGESIZE ) );
+        return size;
+       }
+
+    std::uint64_t FileSize( Po7::fd_t file )
+       {
+        struct ::stat status;
+
+        Po7::Invoke( Po7::FailureFlagResult<int>(),
+                     ::fstat,
+                     Po7::In( file ),
+                     Po7::InOut( status ),
+                     Po7::ThrowErrorFromErrno() );
+
+        return static_cast< std::uint64_t >( status.st_size );
+       }
+   }
+
+Po7::chunked_reader::chunked_reader( std::size_t size, std::size_t threadCount, bool d )
+   : chunkSize( std::max( ( size + PageSize() - 1 ) / PageSize(), std::size_t( 1 ) ) * PageSize() ),
+     direct( d )
+   {
+    if ( threadCount == 0 )
+        threadCount = std::max( std::thread::hardware_concurrency(), 1u );
+
+    // Anonymous memory isn't backed until it's touched, so threads that never get a chunk cost nothing.
+    for ( std::size_t i = 0; i != threadCount; ++i )
+        buffers.push_back( mmap( chunkSize ) );
+   }
+
+void Po7::chunked_reader::Read( std::size_t worker, fd_t file, std::uint64_t fileSize,
+                                std::atomic< std::uint64_t >& nextChunk, std::atomic< bool >& stopping,
+                                const chunk_handler& handler )
+   {
+    char *buffer = buffers[ worker ]->data();
+
+    while ( !stopping )
+       {
+        std::uint64_t offset = nextChunk++ * chunkSize;
+        if ( offset >= fileSize )
+            return;
+
+        std::size_t wanted = static_cast< std::size_t >( std::min< std::uint64_t >( chunkSize, fileSize - offset ) );
+        std::size_t got = 0;
+
+        // Asking for the rest of the buffer, rather than just the rest of the file, keeps the length aligned
+        // for o_direct when the file ends partway through the chunk.
+        while ( got < wanted )
+           {
+            std::size_t n = pread( file, buffer + got, chunkSize - got, static_cast< ::off_t >( offset + got ) );
+            if ( n == 0 )
+                break;
+
+            got += n;
+           }
+
+        if ( got != 0 )
+            handler( offset, buffer, std::min( got, wanted ) );
+
+        if ( got < wanted )
+            return;                 // the file has shrunk
+       }
+   }
+
+std::uint64_t Po7::chunked_reader::read( fd_t file, const chunk_handler& handler )
+   {
+    const std::uint64_t fileSize = FileSize( file );
+    const std::uint64_t chunks = ( fileSize + chunkSize - 1 ) / chunkSize;
+    const std::size_t workers = static_cast< std::size_t >( std::min< std::uint64_t >( buffers.size(), chunks ) );
+
+    std::atomic< std::uint64_t > nextChunk( 0 );
+    std::atomic< std::uint64_t > total( 0 );
+    std::atomic< bool > stopping( false );
+    std::vector< std::exception_ptr > failures( workers );
+    std::vector< std::thread > threads;
+
+    auto counted = [&]( std::uint64_t offset, const char *data, std::size_t length )
+       {
+        handler( offset, data, length );
+        total += length;
+       };
+
+    // If a thread can't be started, the ones already running are stopped and joined before the error
+    // leaves; destroying a joinable thread would terminate the program.
+    try
+       {
+        for ( std::size_t worker = 0; worker != workers; ++worker )
+            threads.emplace_back( [&, worker]
+               {
+                try
+                   {
+                    Read( worker, file, fileSize, nextChunk, stopping, counted );
+                   }
+                catch ( ... )
+                   {
+                    failures[ worker ] = std::current_exception();
+                    stopping = true;
+                   }
+               } );
+       }
+    catch ( ... )
+       {
+        stopping = true;
+
+        for ( auto& thread : threads )
+            thread.join();
+
+        throw;
+       }
+
+    for ( auto& thread : threads )
+        thread.join();
+
+    for ( auto& failure : failures )
+        if ( failure )
+            std::rethrow_exception( failure );
+
+    return total;
+   }
+
+std::uint64_t Po7::chunked_reader::read( const std::string& path, const chunk_handler& handler )
+   {
+    open_flags_t flags = o_rdonly | o_cloexec;
+    unique_fd file;
+
+    #ifdef O_DIRECT
+        if ( direct )
+           {
+            // Filesystems without O_DIRECT, tmpfs among them, refuse it with EINVAL; they get buffered reads.
+            try
+               {
+                file = open( path, flags | o_direct );
+               }
+            catch ( const std::system_error& error )
+               {
+                if ( error.code() != std::errc::invalid_argument )
+                    throw;
+               }
+           }
+    #endif
+
+    if ( !file )
+        file = open( path, flags );
+
+    return read( *file, handler );
+   }
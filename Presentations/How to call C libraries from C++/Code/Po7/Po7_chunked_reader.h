@@ -0,0 +1,70 @@
+//
+//  Po7_chunked_reader.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_CHUNKED_READER_H
+#define PO7_CHUNKED_READER_H
+
+#include "Po7_fcntl.h"
+#include "Po7_mman.h"
+#include "Po7_unistd.h"
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Po7
+   {
+    // chunked_reader reads a whole file on several threads at once, each with pread into a buffer of its own.
+    // One sequential read loop keeps a single request in flight; a fast SSD needs many at once to reach its
+    // bandwidth, and several threads issuing pread on one descriptor is the portable way to get them.
+    //
+    // The file is split into chunks of a fixed size, which the threads take in turn, so a slow chunk doesn't
+    // hold up the rest.  The buffers are anonymous mappings, so they're page-aligned, and the chunk size is a
+    // whole number of pages: that's what O_DIRECT asks of reads that bypass the page cache.
+    //
+    // The handler is called once per chunk, on the reader's threads, concurrently and in no particular order,
+    // with the chunk's offset in the file.  Its data is only valid during the call.  If the handler throws, or
+    // a read fails, the other threads stop at their next chunk and read rethrows the first exception.
+        class chunked_reader
+           {
+            public:
+                using chunk_handler = std::function< void ( std::uint64_t offset, const char *data, std::size_t length ) >;
+
+            private:
+                std::size_t                     chunkSize;
+                std::vector< unique_mapping >   buffers;
+                bool                            direct;
+
+                void Read( std::size_t worker, fd_t, std::uint64_t fileSize,
+                           std::atomic< std::uint64_t >& nextChunk, std::atomic< bool >& stopping,
+                           const chunk_handler& );
+
+            public:
+            // The chunk size is rounded up to whole pages.  With zero threads, there's one per core.
+            // With direct, read( path ) opens files with o_direct when the filesystem supports it.
+                explicit chunked_reader( std::size_t chunkSize = 4 << 20, std::size_t threads = 0, bool direct = false );
+
+                chunked_reader( const chunked_reader& )             = delete;
+                chunked_reader& operator=( const chunked_reader& )  = delete;
+
+                std::size_t chunk_size() const                      { return chunkSize; }
+                std::size_t threads() const                         { return buffers.size(); }
+
+            // read reads a regular file from start to end, as long as it is when read is called, and returns the
+            // number of bytes read.  Each call starts its own threads and joins them before returning.  The
+            // descriptor's offset isn't used or changed; if it was opened with o_direct, the reads respect that.
+            // The calls share the reader's buffers, so a reader does one read at a time; it isn't reentrant,
+            // and threads that read at once need a reader each.
+                std::uint64_t read( fd_t, const chunk_handler& );
+                std::uint64_t read( const std::string& path, const chunk_handler& );
+           };
+   }
+
+#endif
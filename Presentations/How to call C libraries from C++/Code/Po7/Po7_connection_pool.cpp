@@ -0,0 +1,252 @@
+//
+//  Po7_connection_pool.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_connection_pool.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Po7
+   {
+    struct ConnectionPoolCore
+       {
+        struct destination
+           {
+            connection_pool::limits        limits;
+            std::vector< unique_socket >   idle;           // the most recently used at the back
+            std::size_t                    total = 0;      // idle, borrowed, and connecting
+            std::condition_variable        returned;       // waited on by Acquire when total is at the limit
+           };
+
+        connection_pool::limits                  defaults;
+        std::mutex                               mutex;
+        std::map< std::string, std::size_t >     index;
+        std::deque< destination >                destinations;  // a deque, so references survive growth
+       };
+   }
+
+namespace
+   {
+    // Only the parts of an address that say where it goes are in the key; padding and flow labels aren't.
+    std::string DestinationKey( const sockaddr& address, socklen_t length )
+       {
+        std::string key;
+
+        if ( address.sa_family == AF_INET && length >= socklen_t( sizeof( sockaddr_in ) ) )
+           {
+            sockaddr_in a;
+            std::memcpy( &a, &address, sizeof( a ) );
+            key.push_back( char( AF_INET ) );
+            key.append( reinterpret_cast< const char * >( &a.sin_port ), sizeof( a.sin_port ) );
+            key.append( reinterpret_cast< const char * >( &a.sin_addr ), sizeof( a.sin_addr ) );
+           }
+        else if ( address.sa_family == AF_INET6 && length >= socklen_t( sizeof( sockaddr_in6 ) ) )
+           {
+            sockaddr_in6 a;
+            std::memcpy( &a, &address, sizeof( a ) );
+            key.push_back( char( AF_INET6 ) );
+            key.append( reinterpret_cast< const char * >( &a.sin6_port ), sizeof( a.sin6_port ) );
+            key.append( reinterpret_cast< const char * >( &a.sin6_addr ), sizeof( a.sin6_addr ) );
+            key.append( reinterpret_cast< const char * >( &a.sin6_scope_id ), sizeof( a.sin6_scope_id ) );
+           }
+        else
+           {
+            throw std::invalid_argument( "connection_pool handles internet addresses" );
+           }
+
+        return key;
+       }
+
+    // An idle connection should have nothing to read.  A FIN reads as end of file, a reset as an error,
+    // and unrequested data means the connection is out of step; none of those can be reused.
+    bool IsStillOpen( Po7::socket_t s )
+       {
+        char byte;
+        std::error_code error;
+        Po7::recv( s, &byte, 1, Po7::msg_peek | Po7::msg_dontwait, error );
+
+        return error == std::errc::operation_would_block || error == std::errc::resource_unavailable_try_again;
+       }
+   }
+
+Po7::connection_pool::connection_pool( limits l )
+   : core( std::make_shared< ConnectionPoolCore >() )
+   {
+    core->defaults = l;
+   }
+
+Po7::connection_pool::~connection_pool()
+   {
+    // Borrowed sockets hold only weak references, so they're closed when they come back.
+   }
+
+std::size_t Po7::connection_pool::Destination( const sockaddr& address, socklen_t length )
+   {
+    std::string key = DestinationKey( address, length );
+
+    std::lock_guard< std::mutex > lock( core->mutex );
+
+    auto found = core->index.find( key );
+    if ( found != core->index.end() )
+        return found->second;
+
+    core->destinations.emplace_back();
+    core->destinations.back().limits = core->defaults;
+
+    try
+       {
+        core->index.emplace( std::move( key ), core->destinations.size() - 1 );
+       }
+    catch ( ... )
+       {
+        core->destinations.pop_back();
+        throw;
+       }
+
+    return core->destinations.size() - 1;
+   }
+
+auto Po7::connection_pool::Acquire( std::size_t destination, const sockaddr& address, socklen_t length, bool wait ) -> unique_socket
+   {
+    std::unique_lock< std::mutex > lock( core->mutex );
+    ConnectionPoolCore::destination& d = core->destinations[ destination ];
+
+    for (;;)
+       {
+        if ( !d.idle.empty() )
+           {
+            unique_socket s = std::move( d.idle.back() );
+            d.idle.pop_back();
+
+            lock.unlock();
+            if ( IsStillOpen( *s ) )
+                return s;
+            s.reset();
+            lock.lock();
+
+            --d.total;
+            continue;
+           }
+
+        if ( d.total < d.limits.max_total )
+            break;
+
+        if ( !wait )
+            return unique_socket();
+
+        d.returned.wait( lock );
+       }
+
+    // Connect outside the lock, holding a place under the limit.
+    ++d.total;
+    lock.unlock();
+
+    try
+       {
+        unique_socket s = socket( Wrap< socket_domain_t >( int( address.sa_family ) ), sock_stream | sock_cloexec, socket_protocol_t() );
+        connect( *s, address, length );
+        return s;
+       }
+    catch ( ... )
+       {
+        lock.lock();
+        --d.total;
+        d.returned.notify_one();
+        throw;
+       }
+   }
+
+void Po7::connection_pool::GiveBack( const std::weak_ptr< ConnectionPoolCore >& pool, std::size_t destination, socket_t s, bool reusable )
+   {
+    // This is called from a deleter, so it must not throw.  Anything that can't be kept is closed.
+
+    unique_socket returning = Seize< unique_socket >( s );
+    std::shared_ptr< ConnectionPoolCore > core = pool.lock();
+
+    if ( !core )
+        return;
+
+    std::lock_guard< std::mutex > lock( core->mutex );
+    ConnectionPoolCore::destination& d = core->destinations[ destination ];
+
+    if ( reusable && d.idle.size() < d.limits.max_idle )
+       {
+        try
+           {
+            d.idle.push_back( std::move( returning ) );
+           }
+        catch ( ... )
+           {
+           }
+       }
+
+    if ( returning )
+        --d.total;
+
+    d.returned.notify_one();
+   }
+
+void Po7::connection_pool::SetLimits( std::size_t destination, limits l )
+   {
+    std::vector< unique_socket > closing;
+
+    std::lock_guard< std::mutex > lock( core->mutex );
+    ConnectionPoolCore::destination& d = core->destinations[ destination ];
+    d.limits = l;
+
+    // The oldest idle connections go first.
+    std::size_t excess = d.idle.size() > l.max_idle ? d.idle.size() - l.max_idle : 0;
+    closing.reserve( excess );
+    for ( std::size_t i = 0; i < excess; ++i )
+        closing.push_back( std::move( d.idle[ i ] ) );
+
+    d.idle.erase( d.idle.begin(), d.idle.begin() + excess );
+    d.total -= excess;
+
+    // A higher limit may let several waiters in at once.
+    d.returned.notify_all();
+   }
+
+std::size_t Po7::connection_pool::Idle( std::size_t destination ) const
+   {
+    std::lock_guard< std::mutex > lock( core->mutex );
+    return core->destinations[ destination ].idle.size();
+   }
+
+std::size_t Po7::connection_pool::idle() const
+   {
+    std::lock_guard< std::mutex > lock( core->mutex );
+
+    std::size_t count = 0;
+    for ( const ConnectionPoolCore::destination& d : core->destinations )
+        count += d.idle.size();
+
+    return count;
+   }
+
+void Po7::connection_pool::clear()
+   {
+    std::vector< unique_socket > closing;
+
+    std::lock_guard< std::mutex > lock( core->mutex );
+
+    for ( ConnectionPoolCore::destination& d : core->destinations )
+       {
+        d.total -= d.idle.size();
+        std::move( d.idle.begin(), d.idle.end(), std::back_inserter( closing ) );
+        d.idle.clear();
+        d.returned.notify_all();
+       }
+   }
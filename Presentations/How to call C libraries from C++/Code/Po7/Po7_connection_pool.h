@@ -0,0 +1,161 @@
+//
+//  Po7_connection_pool.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_CONNECTION_POOL_H
+#define PO7_CONNECTION_POOL_H
+
+#include "Po7_in.h"
+#include "Po7_socket.h"
+
+#include <cstddef>
+#include <memory>
+
+namespace Po7
+   {
+        class connection_pool;
+        struct ConnectionPoolCore;
+
+    // pooled_socket refers to a connected socket borrowed from a connection_pool.  Instead of closing the
+    // socket, its deleter gives it back to the pool to be reused.  If the pool is gone, the deleter closes it.
+        template < socket_domain_t domain >
+        struct PooledSocketDeleter
+           {
+            using pointer = PlusPlus::PointerToValue< socket_in_domain<domain> >;
+
+            std::weak_ptr< ConnectionPoolCore >  pool;
+            std::size_t                          destination = 0;
+
+            void operator()( pointer s ) const;
+            void discard( pointer s ) const;
+           };
+
+        template < socket_domain_t domain >
+        using pooled_socket = std::unique_ptr< const socket_in_domain<domain>, PooledSocketDeleter<domain> >;
+
+
+    // connection_limits bounds the connections a connection_pool keeps to one destination.
+        struct connection_limits
+           {
+            std::size_t max_idle  = 8;          // connections kept waiting to be reused
+            std::size_t max_total = 64;         // connections open at once, counting those borrowed
+           };
+
+
+    // connection_pool keeps connected stream sockets to each destination, so a client can skip the handshake
+    // when it talks to the same server again.  acquire hands out an idle connection if there is one, or
+    // connects a new one; letting the pooled_socket go puts the connection back.
+    //
+    // A connection that has been idle may have been closed by the peer in the meantime.  Before handing one
+    // out, the pool peeks at it without blocking, and closes it instead if the peer has sent a FIN, a reset,
+    // or data nobody asked for.  A connection that a caller finds unusable partway through a request should be
+    // given to close rather than back to the pool.
+    //
+    // Destinations are sockaddr_in or sockaddr_in6 addresses, and each has its own connection_limits.  acquire
+    // waits for a connection to come back when the limit is reached; try_acquire returns a null socket instead.
+    // The pool may be used from several threads.
+        class connection_pool
+           {
+            public:
+                using limits = connection_limits;
+
+            private:
+                std::shared_ptr< ConnectionPoolCore > core;
+
+                std::size_t Destination( const sockaddr&, socklen_t );
+                unique_socket Acquire( std::size_t destination, const sockaddr&, socklen_t, bool wait );
+
+                template < socket_domain_t domain >
+                pooled_socket< domain > Pooled( std::size_t destination, unique_socket s )
+                   {
+                    PooledSocketDeleter< domain > deleter;
+                    deleter.pool        = core;
+                    deleter.destination = destination;
+
+                    socket_t connected = *s;
+                    s.release();
+
+                    return pooled_socket< domain >( typename PooledSocketDeleter< domain >::pointer( domain_cast< domain >( connected ) ),
+                                                    std::move( deleter ) );
+                   }
+
+                template < class Address, socket_domain_t domain = sockaddr_domain< Address >::value >
+                pooled_socket< domain > Acquire( const Address& address, bool wait )
+                   {
+                    static_assert( domain == af_inet || domain == af_inet6, "connection_pool handles internet domains" );
+
+                    const sockaddr& generic = sockaddr_cast< const sockaddr& >( address );
+                    const socklen_t length  = sockaddr_length( address );
+                    std::size_t destination = Destination( generic, length );
+
+                    return Pooled< domain >( destination, Acquire( destination, generic, length, wait ) );
+                   }
+
+                template < socket_domain_t > friend struct PooledSocketDeleter;
+
+                static void GiveBack( const std::weak_ptr< ConnectionPoolCore >&, std::size_t destination, socket_t, bool reusable );
+
+                void SetLimits( std::size_t destination, limits );
+                std::size_t Idle( std::size_t destination ) const;
+
+            public:
+                explicit connection_pool( limits = limits() );
+                ~connection_pool();
+
+                connection_pool( const connection_pool& )               = delete;
+                connection_pool& operator=( const connection_pool& )    = delete;
+
+            // set_limits changes the limits of one destination; new destinations get the pool's limits.
+            // Lowering max_idle closes the extra idle connections.
+                template < class Address >
+                void set_limits( const Address& address, limits l )
+                   {
+                    SetLimits( Destination( sockaddr_cast< const sockaddr& >( address ), sockaddr_length( address ) ), l );
+                   }
+
+            // acquire returns a connected socket to the address, waiting if the destination is at its limit.
+                template < class Address, socket_domain_t domain = sockaddr_domain< Address >::value >
+                pooled_socket< domain > acquire( const Address& address )       { return Acquire( address, true ); }
+
+            // try_acquire returns a null socket if the destination is at its limit.
+                template < class Address, socket_domain_t domain = sockaddr_domain< Address >::value >
+                pooled_socket< domain > try_acquire( const Address& address )   { return Acquire( address, false ); }
+
+            // idle counts the connections waiting in the pool, for one destination or all of them.
+                template < class Address >
+                std::size_t idle( const Address& address )
+                   {
+                    return Idle( Destination( sockaddr_cast< const sockaddr& >( address ), sockaddr_length( address ) ) );
+                   }
+
+                std::size_t idle() const;
+
+            // clear closes every idle connection.  Borrowed connections are unaffected.
+                void clear();
+           };
+
+    // close closes a pooled socket rather than giving it back, freeing its place for a new connection.
+        template < socket_domain_t domain >
+        void close( pooled_socket< domain > s )
+           {
+            if ( s )
+                s.get_deleter().discard( s.release() );
+           }
+
+        template < socket_domain_t domain >
+        void PooledSocketDeleter< domain >::operator()( pointer s ) const
+           {
+            connection_pool::GiveBack( pool, destination, *s, true );
+           }
+
+        template < socket_domain_t domain >
+        void PooledSocketDeleter< domain >::discard( pointer s ) const
+           {
+            connection_pool::GiveBack( pool, destination, *s, false );
+           }
+   }
+
+#endif
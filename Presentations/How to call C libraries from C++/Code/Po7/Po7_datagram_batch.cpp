@@ -0,0 +1,41 @@
+//
+//  Po7_datagram_batch.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_datagram_batch.h"
+#include "Po7_ResultGroups.h"
+
+std::size_t Po7::recvmmsg( socket_t socket, mmsghdr *messages, unsigned int count, msg_flags_t flags )
+   {
+    return Invoke( int_CountResult(),
+                   ::recvmmsg,
+                   In( socket, messages, count, flags, nullptr ),
+                   ThrowErrorFromErrno() );
+   }
+
+std::size_t Po7::sendmmsg( socket_t socket, mmsghdr *messages, unsigned int count, msg_flags_t flags )
+   {
+    return Invoke( int_CountResult(),
+                   ::sendmmsg,
+                   In( socket, messages, count, flags ),
+                   ThrowErrorFromErrno() );
+   }
+
+std::size_t Po7::try_recvmmsg( socket_t socket, mmsghdr *messages, unsigned int count, msg_flags_t flags )
+   {
+    return Invoke( int_TryCountResult(),
+                   ::recvmmsg,
+                   In( socket, messages, count, flags, nullptr ),
+                   ThrowErrorFromErrno() );
+   }
+
+std::size_t Po7::try_sendmmsg( socket_t socket, mmsghdr *messages, unsigned int count, msg_flags_t flags )
+   {
+    return Invoke( int_TryCountResult(),
+                   ::sendmmsg,
+                   In( socket, messages, count, flags ),
+                   ThrowErrorFromErrno() );
+   }
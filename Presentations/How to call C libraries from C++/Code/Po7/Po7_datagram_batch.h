@@ -0,0 +1,159 @@
+//
+//  Po7_datagram_batch.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_DATAGRAM_BATCH_H
+#define PO7_DATAGRAM_BATCH_H
+
+#include "Po7_socket.h"
+#include "Po7_uio.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <sys/socket.h>
+
+namespace Po7
+   {
+    // recvmmsg and sendmmsg are Linux's batched forms of recvmsg and sendmsg: one call moves many datagrams.
+    // They return the number of messages transferred.
+        using ::mmsghdr;
+
+        std::size_t recvmmsg( socket_t, mmsghdr *messages, unsigned int count, msg_flags_t = msg_flags_t() );
+        std::size_t sendmmsg( socket_t, mmsghdr *messages, unsigned int count, msg_flags_t = msg_flags_t() );
+
+    // The try_ forms return zero, rather than throwing, when a non-blocking socket isn't ready.
+        std::size_t try_recvmmsg( socket_t, mmsghdr *messages, unsigned int count, msg_flags_t = msg_flags_t() );
+        std::size_t try_sendmmsg( socket_t, mmsghdr *messages, unsigned int count, msg_flags_t = msg_flags_t() );
+
+    // With msg_waitforone, recvmmsg blocks only until the first datagram arrives.
+        #ifdef MSG_WAITFORONE
+            const msg_flags_t msg_waitforone = msg_flags_t( MSG_WAITFORONE );
+        #endif
+
+    // The kernel transfers at most this many messages in one call.
+        const std::size_t max_datagram_batch = 1024;
+
+
+    // datagram_batch is a reusable array of datagram slots.  Each slot has a buffer, supplied by the caller,
+    // and a typed address.  recv_batch fills in the address each datagram came from and its length;
+    // send_batch sends each buffer to its slot's address.  On a connected socket, an address left with
+    // a zero family means the connected peer.
+    //
+    // The slots point into the batch itself, so a batch can't be copied.  Keep one around and reuse it:
+    // between calls only the lengths and address lengths need resetting.
+        template < socket_domain_t domain, std::size_t n >
+        class datagram_batch
+           {
+            static_assert( n > 0 && n <= max_datagram_batch, "Batch size out of range" );
+
+            private:
+                mmsghdr                 headers[ n ];
+                iovec                   vectors[ n ];
+                sockaddr_type< domain > addresses[ n ];
+
+            public:
+                datagram_batch()
+                   {
+                    std::memset( headers,   0, sizeof( headers ) );
+                    std::memset( vectors,   0, sizeof( vectors ) );
+                    std::memset( addresses, 0, sizeof( addresses ) );
+
+                    for ( std::size_t i = 0; i < n; ++i )
+                       {
+                        headers[i].msg_hdr.msg_name    = &addresses[i];
+                        headers[i].msg_hdr.msg_namelen = sizeof( addresses[i] );
+                        headers[i].msg_hdr.msg_iov     = &vectors[i];
+                        headers[i].msg_hdr.msg_iovlen  = 1;
+                       }
+                   }
+
+                datagram_batch( const datagram_batch& )             = delete;
+                datagram_batch& operator=( const datagram_batch& )  = delete;
+
+                static constexpr std::size_t capacity()             { return n; }
+
+            // The buffer of a slot is where recv_batch stores a datagram, or what send_batch sends.
+            // Const buffers may only be sent.
+                void set_buffer( std::size_t i, const void *data, std::size_t length )
+                   {
+                    vectors[i].iov_base = const_cast< void * >( data );
+                    vectors[i].iov_len  = length;
+                   }
+
+                template < class Buffer >
+                auto set_buffer( std::size_t i, Buffer& b )
+                -> typename std::enable_if< PlusPlus::stdish::is_bufferlike< typename std::remove_const<Buffer>::type >::value >::type
+                   {
+                    set_buffer( i, PlusPlus::stdish::bufferlike_data( b ), PlusPlus::stdish::bufferlike_size( b ) );
+                   }
+
+                char *buffer( std::size_t i ) const                 { return static_cast< char * >( vectors[i].iov_base ); }
+
+            // The address of a slot is where a received datagram came from, or where a sent one goes.
+                sockaddr_type< domain >&       address( std::size_t i )         { return addresses[i]; }
+                const sockaddr_type< domain >& address( std::size_t i ) const   { return addresses[i]; }
+
+            // The length of a slot is the number of bytes transferred by the last batch call.
+                std::size_t length( std::size_t i ) const           { return headers[i].msg_len; }
+                bool truncated( std::size_t i ) const               { return ( headers[i].msg_hdr.msg_flags & MSG_TRUNC ) != 0; }
+
+            // These reset the parts of the first count slots that the kernel overwrites.
+                mmsghdr *PrepareToReceive( std::size_t count )
+                   {
+                    for ( std::size_t i = 0; i < count; ++i )
+                        headers[i].msg_hdr.msg_namelen = sizeof( addresses[i] );
+                    return headers;
+                   }
+
+                mmsghdr *PrepareToSend( std::size_t count )
+                   {
+                    for ( std::size_t i = 0; i < count; ++i )
+                        headers[i].msg_hdr.msg_namelen = sockaddr_cast< sockaddr& >( addresses[i] ).sa_family == AF_UNSPEC
+                                                             ? 0
+                                                             : sockaddr_length( addresses[i] );
+                    return headers;
+                   }
+           };
+
+
+    // recv_batch and send_batch transfer the first count slots of a batch in one call,
+    // and return the number of datagrams transferred.
+        template < socket_domain_t domain, std::size_t n >
+        std::size_t recv_batch( socket_in_domain<domain> s, datagram_batch<domain,n>& batch, std::size_t count = n, msg_flags_t f = msg_flags_t() )
+           {
+            if ( count > n )
+                throw std::out_of_range( "More datagrams than the batch holds" );
+            return recvmmsg( s, batch.PrepareToReceive( count ), static_cast< unsigned int >( count ), f );
+           }
+
+        template < socket_domain_t domain, std::size_t n >
+        std::size_t send_batch( socket_in_domain<domain> s, datagram_batch<domain,n>& batch, std::size_t count = n, msg_flags_t f = msg_flags_t() )
+           {
+            if ( count > n )
+                throw std::out_of_range( "More datagrams than the batch holds" );
+            return sendmmsg( s, batch.PrepareToSend( count ), static_cast< unsigned int >( count ), f );
+           }
+
+    // try_recv_batch and try_send_batch return zero when a non-blocking socket isn't ready.
+        template < socket_domain_t domain, std::size_t n >
+        std::size_t try_recv_batch( socket_in_domain<domain> s, datagram_batch<domain,n>& batch, std::size_t count = n, msg_flags_t f = msg_flags_t() )
+           {
+            if ( count > n )
+                throw std::out_of_range( "More datagrams than the batch holds" );
+            return try_recvmmsg( s, batch.PrepareToReceive( count ), static_cast< unsigned int >( count ), f );
+           }
+
+        template < socket_domain_t domain, std::size_t n >
+        std::size_t try_send_batch( socket_in_domain<domain> s, datagram_batch<domain,n>& batch, std::size_t count = n, msg_flags_t f = msg_flags_t() )
+           {
+            if ( count > n )
+                throw std::out_of_range( "More datagrams than the batch holds" );
+            return try_sendmmsg( s, batch.PrepareToSend( count ), static_cast< unsigned int >( count ), f );
+           }
+   }
+
+#endif
@@ -0,0 +1,106 @@
+//
+//  Po7_epoll.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_epoll.h"
+#include "Po7_ResultGroups.h"
+
+#include <cstring>
+
+void Po7::EpollDeleter::operator()( pointer p ) const
+   {
+    // Don't use Invoke in the deleter; this must ignore errors
+
+    int epoll = Unwrap( *p );
+
+    if ( epoll != -1 )
+        ::close( epoll );
+   }
+
+auto Po7::epoll_create1( epoll_create_flags_t flags ) -> unique_epoll
+   {
+    return Invoke( Result< unique_epoll >() + FailsWhenFalse(),
+                   ::epoll_create1,
+                   In( flags ),
+                   ThrowErrorFromErrno() );
+   }
+
+auto Po7::epoll_create1( epoll_create_flags_t flags, std::error_code& error ) -> unique_epoll
+   {
+    return Invoke( Result< unique_epoll >() + FailsWhenFalse(),
+                   ::epoll_create1,
+                   In( flags ),
+                   ReportErrorFromErrno( error ) );
+   }
+
+void Po7::close( unique_epoll e )
+   {
+    return Invoke( FailureFlagResult<int>(),
+                   ::close,
+                   In( std::move( e ) ),
+                   ThrowErrorFromErrno() );
+   }
+
+auto Po7::MakeAnything( ThingToMake< epoll_event >, epoll_events_t events, std::uint64_t data ) -> epoll_event
+   {
+    epoll_event result;
+    std::memset( &result, 0, sizeof( result ) );
+
+    result.events   = Unwrap( events );
+    result.data.u64 = data;
+
+    return result;
+   }
+
+void Po7::epoll_ctl( epoll_t epoll, epoll_ctl_op_t op, fd_t descriptor, epoll_event& event )
+   {
+    return Invoke( FailureFlagResult<int>(),
+                   ::epoll_ctl,
+                   In( epoll, op, descriptor ),
+                   InOut( event ),
+                   ThrowErrorFromErrno() );
+   }
+
+void Po7::epoll_ctl( epoll_t epoll, epoll_ctl_op_t op, fd_t descriptor )
+   {
+    return Invoke( FailureFlagResult<int>(),
+                   ::epoll_ctl,
+                   In( epoll, op, descriptor, nullptr ),
+                   ThrowErrorFromErrno() );
+   }
+
+std::size_t Po7::epoll_wait( epoll_t epoll, epoll_event *events, int maxEvents, int timeoutMilliseconds )
+   {
+    return Invoke( int_InterruptibleCountResult(),
+                   ::epoll_wait,
+                   In( epoll, events, maxEvents, timeoutMilliseconds ),
+                   ThrowErrorFromErrno() );
+   }
+
+void Po7::epoll_ctl( epoll_t epoll, epoll_ctl_op_t op, fd_t descriptor, epoll_event& event, std::error_code& error )
+   {
+    return Invoke( FailureFlagResult<int>(),
+                   ::epoll_ctl,
+                   In( epoll, op, descriptor ),
+                   InOut( event ),
+                   ReportErrorFromErrno( error ) );
+   }
+
+void Po7::epoll_ctl( epoll_t epoll, epoll_ctl_op_t op, fd_t descriptor, std::error_code& error )
+   {
+    return Invoke( FailureFlagResult<int>(),
+                   ::epoll_ctl,
+                   In( epoll, op, descriptor, nullptr ),
+                   ReportErrorFromErrno( error ) );
+   }
+
+std::size_t Po7::epoll_wait( epoll_t epoll, epoll_event *events, int maxEvents, int timeoutMilliseconds, std::error_code& error )
+   {
+    return Invoke( int_InterruptibleCountResult(),
+                   ::epoll_wait,
+                   In( epoll, events, maxEvents, timeoutMilliseconds ),
+                   ReportErrorFromErrno( error ) );
+   }
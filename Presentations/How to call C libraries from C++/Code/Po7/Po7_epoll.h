@@ -0,0 +1,142 @@
+//
+//  Po7_epoll.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_EPOLL_H
+#define PO7_EPOLL_H
+
+#include "Po7_Basics.h"
+#include "Po7_socket.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <system_error>
+
+#include <sys/epoll.h>
+
+namespace Po7
+   {
+    // epoll isn't POSIX, but it's the way Linux multiplexes large numbers of sockets.
+
+    // epoll_t represents an epoll instance
+        struct EpollTag
+           {
+            constexpr int operator()() const            { return -1; }
+            static const bool hasEquality               = true;
+            static const bool hasComparison             = true;
+           };
+
+        using epoll_t = PlusPlus::Boxed< EpollTag >;
+
+    // unique_epoll refers to an epoll instance, and represents the obligation to close it
+        struct EpollDeleter
+           {
+            using pointer = PlusPlus::PointerToValue< epoll_t >;
+            void operator()( pointer e ) const;
+           };
+
+        using unique_epoll = std::unique_ptr< const epoll_t, EpollDeleter >;
+
+
+    // epoll_create_flags_t is the parameter to epoll_create1()
+        struct EpollCreateFlagsTag
+           {
+            constexpr int operator()() const                { return 0; }
+            static const bool hasEquality                   = true;
+            static const bool hasBitwise                    = true;
+           };
+
+        using epoll_create_flags_t = PlusPlus::Boxed< EpollCreateFlagsTag >;
+
+        const epoll_create_flags_t epoll_cloexec = epoll_create_flags_t( EPOLL_CLOEXEC );
+
+    // epoll_create1() creates epoll instances, and close() gets rid of them.
+        unique_epoll epoll_create1( epoll_create_flags_t = epoll_create_flags_t() );
+        unique_epoll epoll_create1( epoll_create_flags_t, std::error_code& );
+
+        void close( unique_epoll );
+
+
+    // epoll_events_t is the bit set in epoll_event::events
+        struct EpollEventsTag
+           {
+            constexpr std::uint32_t operator()() const      { return 0; }
+            static const bool hasEquality                   = true;
+            static const bool hasBitwise                    = true;
+            static const bool convertsToBool                = true;
+           };
+
+        using epoll_events_t = PlusPlus::Boxed< EpollEventsTag >;
+
+        const epoll_events_t epollin      = epoll_events_t( EPOLLIN );
+        const epoll_events_t epollout     = epoll_events_t( EPOLLOUT );
+        const epoll_events_t epollrdhup   = epoll_events_t( EPOLLRDHUP );
+        const epoll_events_t epollpri     = epoll_events_t( EPOLLPRI );
+        const epoll_events_t epollerr     = epoll_events_t( EPOLLERR );
+        const epoll_events_t epollhup     = epoll_events_t( EPOLLHUP );
+        const epoll_events_t epollet      = epoll_events_t( EPOLLET );
+        const epoll_events_t epolloneshot = epoll_events_t( EPOLLONESHOT );
+
+    // epoll_event pairs the events with a 64-bit cookie identifying the registration
+        using ::epoll_event;
+
+        epoll_event MakeAnything( ThingToMake< epoll_event >, epoll_events_t, std::uint64_t data );
+
+
+    // epoll_ctl_op_t is the second parameter to epoll_ctl()
+        enum class epoll_ctl_op_t: int {};
+        template <> struct Wrapper< epoll_ctl_op_t >: PlusPlus::EnumWrapper< epoll_ctl_op_t > {};
+
+        const epoll_ctl_op_t epoll_ctl_add = epoll_ctl_op_t( EPOLL_CTL_ADD );
+        const epoll_ctl_op_t epoll_ctl_mod = epoll_ctl_op_t( EPOLL_CTL_MOD );
+        const epoll_ctl_op_t epoll_ctl_del = epoll_ctl_op_t( EPOLL_CTL_DEL );
+
+    // epoll_ctl adds, modifies, and removes the descriptors an epoll instance watches: sockets, and also
+    // eventfds, timerfds, and signalfds.  The form without an event is for epoll_ctl_del.
+        void epoll_ctl( epoll_t, epoll_ctl_op_t, fd_t, epoll_event& );
+        void epoll_ctl( epoll_t, epoll_ctl_op_t, fd_t );
+
+    // The forms taking an error_code report errors there instead of throwing.
+        void epoll_ctl( epoll_t, epoll_ctl_op_t, fd_t, epoll_event&, std::error_code& );
+        void epoll_ctl( epoll_t, epoll_ctl_op_t, fd_t, std::error_code& );
+
+
+    // epoll_wait returns the number of events stored.  A negative timeout waits forever.  A wait interrupted
+    // by a signal returns zero, as if it had timed out; it's normal, and not worth an exception.  A duration
+    // too long for an int is cut short rather than wrapped around, so it can't turn into waiting forever.
+        std::size_t epoll_wait( epoll_t, epoll_event *events, int maxEvents, int timeoutMilliseconds );
+        std::size_t epoll_wait( epoll_t, epoll_event *events, int maxEvents, int timeoutMilliseconds, std::error_code& );
+
+        inline int EpollTimeout( std::chrono::milliseconds timeout )
+           {
+            const std::chrono::milliseconds::rep longest = std::numeric_limits< int >::max();
+            return static_cast< int >( timeout.count() < 0 ? -1 : std::min( timeout.count(), longest ) );
+           }
+
+        template < std::size_t n >
+        std::size_t epoll_wait( epoll_t e, epoll_event (&events)[n], std::chrono::milliseconds timeout )
+           {
+            static_assert( n <= static_cast< std::size_t >( std::numeric_limits< int >::max() ), "Too many events" );
+            return epoll_wait( e, events, static_cast< int >( n ), EpollTimeout( timeout ) );
+           }
+
+        template < std::size_t n >
+        std::size_t epoll_wait( epoll_t e, epoll_event (&events)[n], std::chrono::milliseconds timeout, std::error_code& error )
+           {
+            static_assert( n <= static_cast< std::size_t >( std::numeric_limits< int >::max() ), "Too many events" );
+            return epoll_wait( e, events, static_cast< int >( n ), EpollTimeout( timeout ), error );
+           }
+
+        template < std::size_t n >
+        std::size_t epoll_wait( epoll_t e, epoll_event (&events)[n] )
+           {
+            return epoll_wait( e, events, std::chrono::milliseconds( -1 ) );
+           }
+   }
+
+#endif
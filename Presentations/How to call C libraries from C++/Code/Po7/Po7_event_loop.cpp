@@ -0,0 +1,197 @@
+//
+//  Po7_event_loop.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_event_loop.h"
+
+namespace
+   {
+    // The epoll cookie carries the descriptor and the generation of its slot,
+    // so events for a socket removed earlier in the same round can be recognized.
+
+    std::uint64_t MakeCookie( int descriptor, std::uint32_t generation )
+       {
+        return ( std::uint64_t( generation ) << 32 ) | std::uint32_t( descriptor );
+       }
+
+    int CookieDescriptor( std::uint64_t cookie )
+       {
+        return static_cast< int >( cookie & 0xFFFFFFFFu );
+       }
+
+    std::uint32_t CookieGeneration( std::uint64_t cookie )
+       {
+        return static_cast< std::uint32_t >( cookie >> 32 );
+       }
+   }
+
+Po7::event_loop::event_loop()
+   : epoll( epoll_create1( epoll_cloexec ) )
+   {}
+
+auto Po7::event_loop::SlotFor( fd_t d ) -> slot&
+   {
+    std::size_t index = static_cast< std::size_t >( Unwrap( d ) );
+
+    if ( index >= slots.size() || !slots[ index ].descriptor )
+        throw std::invalid_argument( "Descriptor is not registered with the event loop" );
+
+    return slots[ index ];
+   }
+
+auto Po7::event_loop::Add( unique_fd d, epoll_events_t events ) -> slot&
+   {
+    int descriptor = Unwrap( *d );
+    if ( descriptor < 0 )
+        throw std::invalid_argument( "Can't register a null descriptor" );
+
+    std::size_t index = static_cast< std::size_t >( descriptor );
+    if ( index >= slots.size() )
+        slots.resize( index + 1 );
+
+    slot& target = slots[ index ];
+    epoll_event event = Make< epoll_event >( events | epollet, MakeCookie( descriptor, target.generation ) );
+    epoll_ctl( *epoll, epoll_ctl_add, *d, event );
+
+    target.descriptor = std::move( d );
+    ++registered;
+
+    return target;
+   }
+
+void Po7::event_loop::add( unique_socket s, epoll_events_t events, handler h )
+   {
+    slot& target = Add( std::move( s ), events );
+    target.onReady  = std::move( h );
+    target.isSocket = true;
+   }
+
+void Po7::event_loop::add( unique_fd d, epoll_events_t events, descriptor_handler h )
+   {
+    slot& target = Add( std::move( d ), events );
+    target.onDescriptorReady = std::move( h );
+    target.isSocket          = false;
+   }
+
+void Po7::event_loop::modify( fd_t d, epoll_events_t events )
+   {
+    slot& target = SlotFor( d );
+    epoll_event event = Make< epoll_event >( events | epollet, MakeCookie( Unwrap( d ), target.generation ) );
+    epoll_ctl( *epoll, epoll_ctl_mod, d, event );
+   }
+
+auto Po7::event_loop::Remove( fd_t d ) -> unique_fd
+   {
+    slot& target = SlotFor( d );
+    epoll_ctl( *epoll, epoll_ctl_del, d );
+
+    ++target.generation;
+    target.onReady           = nullptr;
+    target.onDescriptorReady = nullptr;
+    --registered;
+
+    return std::move( target.descriptor );
+   }
+
+auto Po7::event_loop::remove( socket_t s ) -> unique_socket
+   {
+    unique_fd removed = Remove( s );
+    return Seize< unique_socket >( Wrap< socket_t >( Unwrap( *removed.release() ) ) );
+   }
+
+auto Po7::event_loop::remove( fd_t d ) -> unique_fd
+   {
+    return Remove( d );
+   }
+
+void Po7::event_loop::close( socket_t s )
+   {
+    Po7::close( Remove( s ) );
+   }
+
+void Po7::event_loop::close( fd_t d )
+   {
+    Po7::close( Remove( d ) );
+   }
+
+bool Po7::event_loop::contains( fd_t d ) const
+   {
+    std::size_t index = static_cast< std::size_t >( Unwrap( d ) );
+    return index < slots.size() && slots[ index ].descriptor && *slots[ index ].descriptor == d;
+   }
+
+// Dispatch holds the handler outside its slot while it runs, so it survives the handler removing its own descriptor.
+template < class Handler, class Descriptor >
+void Po7::event_loop::Dispatch( std::size_t index, std::uint32_t generation, Handler slot::*member, Descriptor d, epoll_events_t ready )
+   {
+    Handler running = std::move( slots[ index ].*member );
+
+    try
+       {
+        running( d, ready );
+       }
+    catch ( ... )
+       {
+        if ( slots[ index ].descriptor && slots[ index ].generation == generation )
+            slots[ index ].*member = std::move( running );
+        throw;
+       }
+
+    if ( slots[ index ].descriptor && slots[ index ].generation == generation )
+        slots[ index ].*member = std::move( running );
+   }
+
+std::size_t Po7::event_loop::run_once( std::chrono::milliseconds timeout )
+   {
+    epoll_event events[ 256 ];
+    std::size_t count = epoll_wait( *epoll, events, timeout );
+
+    std::size_t dispatched = 0;
+    std::exception_ptr failure;
+
+    // Edge-triggered events aren't delivered again, so a handler that throws mustn't cost the rest of the
+    // round theirs.  The round finishes, and then the first exception is rethrown.
+    for ( std::size_t i = 0; i < count; ++i )
+       {
+        std::uint64_t  cookie     = events[ i ].data.u64;     // epoll_event may be packed; copy its fields out
+        epoll_events_t ready      = Wrap< epoll_events_t >( std::uint32_t( events[ i ].events ) );
+        std::size_t    index      = static_cast< std::size_t >( CookieDescriptor( cookie ) );
+        std::uint32_t  generation = CookieGeneration( cookie );
+
+        if ( index >= slots.size() || !slots[ index ].descriptor || slots[ index ].generation != generation )
+            continue;
+
+        fd_t descriptor = *slots[ index ].descriptor;
+
+        try
+           {
+            if ( slots[ index ].isSocket )
+                Dispatch( index, generation, &slot::onReady, Wrap< socket_t >( Unwrap( descriptor ) ), ready );
+            else
+                Dispatch( index, generation, &slot::onDescriptorReady, descriptor, ready );
+           }
+        catch ( ... )
+           {
+            if ( !failure )
+                failure = std::current_exception();
+           }
+
+        ++dispatched;
+       }
+
+    if ( failure )
+        std::rethrow_exception( failure );
+
+    return dispatched;
+   }
+
+void Po7::event_loop::run()
+   {
+    stopping = false;
+
+    while ( !stopping && registered != 0 )
+        run_once();
+   }
@@ -0,0 +1,123 @@
+//
+//  Po7_event_loop.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_EVENT_LOOP_H
+#define PO7_EVENT_LOOP_H
+
+#include "Po7_socket.h"
+#include "Po7_epoll.h"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+
+namespace Po7
+   {
+    // event_loop multiplexes many sockets onto one thread, calling a handler when a socket becomes ready.
+    //
+    // Registering a socket hands its unique_socket to the loop.  The loop keeps it in a table indexed by
+    // the descriptor, so the only per-socket storage is the PointerToValue<socket_t> inside the unique_socket
+    // and the handler; there's no heap node per descriptor.  Handlers small enough for std::function's
+    // internal buffer (a pointer or two) don't allocate either.
+    //
+    // Readiness is edge-triggered: a handler is called again only after new data arrives or buffer space
+    // frees up, so handlers should read or write until the socket would block.  Register non-blocking sockets
+    // (sock_nonblock, accept4) and use the try_ forms from Po7_socket.h to find that point without exceptions.
+    //
+    // Handlers may add, modify, or remove sockets (including their own) while they run.  A socket that is
+    // removed during a round of dispatch receives no further events from that round, even if its descriptor
+    // number is reused.
+    //
+    // Other descriptors can share the loop: an eventfd to wake it from another thread, a timerfd for timers,
+    // a signalfd for signals.  They're added as unique_fd (the unique_ptrs from Po7_eventfd.h and the like
+    // convert), and their handlers receive an fd_t.  Everything else about them works as for sockets.
+
+        class event_loop
+           {
+            public:
+                using handler            = std::function< void ( socket_t, epoll_events_t ) >;
+                using descriptor_handler = std::function< void ( fd_t, epoll_events_t ) >;
+
+            private:
+                struct slot
+                   {
+                    unique_fd           descriptor;
+                    handler             onReady;                // for a socket
+                    descriptor_handler  onDescriptorReady;      // for anything else
+                    bool                isSocket   = false;
+                    std::uint32_t       generation = 0;
+                   };
+
+                unique_epoll        epoll;
+                std::deque< slot >  slots;          // a deque, so growing it doesn't move a running handler
+                std::size_t         registered = 0;
+                bool                stopping   = false;
+
+                slot& SlotFor( fd_t );
+                slot& Add( unique_fd, epoll_events_t );
+                unique_fd Remove( fd_t );
+
+                template < class Handler, class Descriptor >
+                void Dispatch( std::size_t index, std::uint32_t generation, Handler slot::*, Descriptor, epoll_events_t );
+
+            public:
+                event_loop();
+
+                event_loop( const event_loop& )             = delete;
+                event_loop& operator=( const event_loop& )  = delete;
+
+            // add registers a socket; the events are made edge-triggered.
+                void add( unique_socket, epoll_events_t, handler );
+
+                template < socket_domain_t domain >
+                void add( unique_socket_in_domain<domain> s, epoll_events_t events, handler h )
+                   {
+                    add( unique_socket( std::move( s ) ), events, std::move( h ) );
+                   }
+
+                void add( unique_fd, epoll_events_t, descriptor_handler );
+
+            // modify changes the events a registered descriptor is watched for.
+                void modify( fd_t, epoll_events_t );
+
+            // remove unregisters a descriptor and gives it back; close unregisters and closes it.  A socket with
+            // a domain converts to both socket_t and fd_t, so it has forms of its own.
+                unique_socket remove( socket_t );
+                unique_fd remove( fd_t );
+                void close( socket_t );
+                void close( fd_t );
+
+                template < socket_domain_t domain >
+                unique_socket_in_domain<domain> remove( socket_in_domain<domain> s )
+                   {
+                    return domain_cast< domain >( remove( socket_t( s ) ) );
+                   }
+
+                template < socket_domain_t domain >
+                void close( socket_in_domain<domain> s )
+                   {
+                    close( socket_t( s ) );
+                   }
+
+                bool contains( fd_t ) const;
+                std::size_t size() const                    { return registered; }
+
+            // run_once waits up to the timeout (forever if negative) and dispatches one round of events.
+            // It returns the number of handlers called.  If handlers throw, the rest of the round is still
+            // dispatched, and then the first exception is rethrown.
+                std::size_t run_once( std::chrono::milliseconds timeout = std::chrono::milliseconds( -1 ) );
+
+            // run dispatches until stop is called or no sockets remain.
+                void run();
+                void stop()                                 { stopping = true; }
+           };
+   }
+
+#endif
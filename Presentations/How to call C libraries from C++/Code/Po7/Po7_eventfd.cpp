@@ -0,0 +1,70 @@
+//
+//  Po7_eventfd.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_eventfd.h"
+#include "Po7_ResultGroups.h"
+
+void Po7::EventFDDeleter::operator()( pointer p ) const
+   {
+    // Don't use Invoke in the deleter; this must ignore errors
+
+    int descriptor = Unwrap( *p );
+
+    if ( descriptor != -1 )
+        ::close( descriptor );
+   }
+
+auto Po7::eventfd( unsigned int initialCount, eventfd_flags_t flags ) -> unique_eventfd
+   {
+    return Invoke( Result< unique_eventfd >() + FailsWhenFalse(),
+                   ::eventfd,
+                   In( initialCount, flags ),
+                   ThrowErrorFromErrno() );
+   }
+
+void Po7::close( unique_eventfd e )
+   {
+    return Invoke( FailureFlagResult<int>(),
+                   ::close,
+                   In( std::move( e ) ),
+                   ThrowErrorFromErrno() );
+   }
+
+std::uint64_t Po7::eventfd_read( eventfd_t e )
+   {
+    ::eventfd_t count = 0;
+
+    Invoke( FailureFlagResult<int>(),
+            ::eventfd_read,
+            In( e ),
+            InOut( count ),
+            ThrowErrorFromErrno() );
+
+    return count;
+   }
+
+void Po7::eventfd_write( eventfd_t e, std::uint64_t value )
+   {
+    return Invoke( FailureFlagResult<int>(),
+                   ::eventfd_write,
+                   In( e, ::eventfd_t( value ) ),
+                   ThrowErrorFromErrno() );
+   }
+
+std::uint64_t Po7::try_eventfd_read( eventfd_t e )
+   {
+    // A read that would block leaves the count at zero.
+    ::eventfd_t count = 0;
+
+    Invoke( int_TryFlagResult(),
+            ::eventfd_read,
+            In( e ),
+            InOut( count ),
+            ThrowErrorFromErrno() );
+
+    return count;
+   }
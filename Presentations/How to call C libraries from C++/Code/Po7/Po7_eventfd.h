@@ -0,0 +1,76 @@
+//
+//  Po7_eventfd.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_EVENTFD_H
+#define PO7_EVENTFD_H
+
+#include "Po7_Basics.h"
+#include "Po7_unistd.h"
+
+#include <cstdint>
+#include <memory>
+
+#include <sys/eventfd.h>
+
+namespace Po7
+   {
+    // eventfd isn't POSIX either.  An eventfd is a 64-bit counter with a descriptor: writing adds to it, and
+    // reading takes the count and resets it.  It's readable while the count is nonzero, so an epoll instance
+    // can wait for it along with its sockets.  That makes it the way to wake another thread's event loop.
+
+    // eventfd_t represents an eventfd.  (It's Po7's descriptor type, not the counter type in <sys/eventfd.h>.)
+        struct EventFDTag
+           {
+            constexpr int operator()() const            { return -1; }
+            static const bool hasEquality               = true;
+            static const bool hasComparison             = true;
+            constexpr operator FileDescriptorTag() const { return FileDescriptorTag(); }
+           };
+
+        using eventfd_t = PlusPlus::Boxed< EventFDTag >;
+
+    // unique_eventfd refers to an eventfd, and represents the obligation to close it
+        struct EventFDDeleter
+           {
+            using pointer = PlusPlus::PointerToValue< eventfd_t >;
+            void operator()( pointer e ) const;
+            operator FileDescriptorDeleter() const  { return FileDescriptorDeleter(); }
+           };
+
+        using unique_eventfd = std::unique_ptr< const eventfd_t, EventFDDeleter >;
+
+
+    // eventfd_flags_t is the second parameter to eventfd()
+        struct EventFDFlagsTag
+           {
+            constexpr int operator()() const                { return 0; }
+            static const bool hasEquality                   = true;
+            static const bool hasBitwise                    = true;
+           };
+
+        using eventfd_flags_t = PlusPlus::Boxed< EventFDFlagsTag >;
+
+        const eventfd_flags_t efd_cloexec   = eventfd_flags_t( EFD_CLOEXEC );
+        const eventfd_flags_t efd_nonblock  = eventfd_flags_t( EFD_NONBLOCK );
+        const eventfd_flags_t efd_semaphore = eventfd_flags_t( EFD_SEMAPHORE );   // reads take one at a time
+
+    // eventfd() creates eventfds, and close() gets rid of them.
+        unique_eventfd eventfd( unsigned int initialCount = 0, eventfd_flags_t = eventfd_flags_t() );
+
+        void close( unique_eventfd );
+
+    // eventfd_read waits for a nonzero count, then returns it and resets the count to zero (or, for an
+    // efd_semaphore eventfd, returns 1 and decrements it).  eventfd_write adds to the count.
+        std::uint64_t eventfd_read( eventfd_t );
+        void eventfd_write( eventfd_t, std::uint64_t = 1 );
+
+    // try_eventfd_read is for efd_nonblock eventfds: when the count is zero, it returns zero instead of
+    // reporting EAGAIN.  A successful read never returns zero, so there's no ambiguity.
+        std::uint64_t try_eventfd_read( eventfd_t );
+   }
+
+#endif
@@ -0,0 +1,79 @@
+//
+//  Po7_fcntl.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_fcntl.h"
+#include "Po7_Invoke.h"
+
+namespace
+   {
+    // fcntl takes variable arguments, which Invoke can't forward; these fix the command.
+
+    int GetStatusFlags( int fd )                { return ::fcntl( fd, F_GETFL ); }
+    int SetStatusFlags( int fd, int flags )     { return ::fcntl( fd, F_SETFL, flags ); }
+
+    struct int_FlagsResult
+       {
+        using ResultType                                                    = int;
+        bool CheckForFailure( int r ) const                                 { return r == -1; }
+        std::tuple<> ThrownParts( int ) const                               { return std::tuple<>(); }
+        std::tuple< Po7::open_flags_t > ReturnedParts( int r ) const        { return std::make_tuple( Po7::Wrap< Po7::open_flags_t >( r ) ); }
+       };
+   }
+
+auto Po7::open( const char *path, open_flags_t flags, mode_t mode ) -> unique_fd
+   {
+    return Invoke( Result< unique_fd >() + FailsWhenFalse(),
+                   ::open,
+                   In( path, flags, mode ),
+                   ThrowErrorFromErrno() );
+   }
+
+auto Po7::fcntl_getfl( fd_t fd ) -> open_flags_t
+   {
+    return Invoke( int_FlagsResult(),
+                   GetStatusFlags,
+                   In( fd ),
+                   ThrowErrorFromErrno() );
+   }
+
+void Po7::fcntl_setfl( fd_t fd, open_flags_t flags )
+   {
+    return Invoke( FailureFlagResult<int>(),
+                   SetStatusFlags,
+                   In( fd, flags ),
+                   ThrowErrorFromErrno() );
+   }
+
+auto Po7::fcntl_getfl( fd_t fd, std::error_code& error ) -> open_flags_t
+   {
+    return Invoke( int_FlagsResult(),
+                   GetStatusFlags,
+                   In( fd ),
+                   ReportErrorFromErrno( error ) );
+   }
+
+void Po7::fcntl_setfl( fd_t fd, open_flags_t flags, std::error_code& error )
+   {
+    return Invoke( FailureFlagResult<int>(),
+                   SetStatusFlags,
+                   In( fd, flags ),
+                   ReportErrorFromErrno( error ) );
+   }
+
+auto Po7::pipe( open_flags_t flags ) -> std::tuple< unique_fd, unique_fd >
+   {
+    int descriptors[ 2 ];
+    int *ends = descriptors;
+
+    Invoke( FailureFlagResult<int>(),
+            ::pipe2,
+            In( ends, flags ),
+            ThrowErrorFromErrno() );
+
+    return std::make_tuple( Seize< unique_fd >( Wrap< fd_t >( descriptors[0] ) ),
+                            Seize< unique_fd >( Wrap< fd_t >( descriptors[1] ) ) );
+   }
@@ -0,0 +1,78 @@
+//
+//  Po7_fcntl.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_FCNTL_H
+#define PO7_FCNTL_H
+
+#include "Po7_Basics.h"
+#include "Po7_unistd.h"
+
+#include <string>
+#include <system_error>
+#include <tuple>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+namespace Po7
+   {
+    // open_flags_t is the second parameter to open()
+        struct OpenFlagsTag
+           {
+            constexpr int operator()() const                { return 0; }
+            static const bool hasEquality                   = true;
+            static const bool hasBitwise                    = true;
+           };
+
+        using open_flags_t = PlusPlus::Boxed< OpenFlagsTag >;
+
+        const open_flags_t o_rdonly   = open_flags_t( O_RDONLY );
+        const open_flags_t o_wronly   = open_flags_t( O_WRONLY );
+        const open_flags_t o_rdwr     = open_flags_t( O_RDWR );
+        const open_flags_t o_append   = open_flags_t( O_APPEND );
+        const open_flags_t o_creat    = open_flags_t( O_CREAT );
+        const open_flags_t o_excl     = open_flags_t( O_EXCL );
+        const open_flags_t o_trunc    = open_flags_t( O_TRUNC );
+        const open_flags_t o_nonblock = open_flags_t( O_NONBLOCK );
+        #ifdef O_CLOEXEC
+            const open_flags_t o_cloexec = open_flags_t( O_CLOEXEC );
+        #endif
+        #ifdef O_DIRECT
+            const open_flags_t o_direct  = open_flags_t( O_DIRECT );     // bypasses the page cache; see Po7_chunked_reader.h
+        #endif
+
+    // mode_t holds the permission bits given to a file open() creates
+        struct ModeTag
+           {
+            constexpr ::mode_t operator()() const           { return 0; }
+            static const bool hasEquality                   = true;
+            static const bool hasBitwise                    = true;
+           };
+
+        using mode_t = PlusPlus::Boxed< ModeTag >;
+
+    // open() opens files; close() in Po7_unistd.h gets rid of them.
+        unique_fd open( const char *path, open_flags_t, mode_t = mode_t( 0666 ) );
+
+        inline unique_fd open( const std::string& path, open_flags_t flags, mode_t mode = mode_t( 0666 ) )
+           {
+            return open( path.c_str(), flags, mode );
+           }
+
+    // fcntl_getfl and fcntl_setfl read and replace a descriptor's status flags, such as o_nonblock.
+        open_flags_t fcntl_getfl( fd_t );
+        void fcntl_setfl( fd_t, open_flags_t );
+
+    // These forms report errors through the error_code instead of throwing.
+        open_flags_t fcntl_getfl( fd_t, std::error_code& );
+        void fcntl_setfl( fd_t, open_flags_t, std::error_code& );
+
+    // pipe makes a pipe, returning its reading end first.  The flags may include o_cloexec and o_nonblock.
+        std::tuple< unique_fd, unique_fd > pipe( open_flags_t = open_flags_t() );
+   }
+
+#endif
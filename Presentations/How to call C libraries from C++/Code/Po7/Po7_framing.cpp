@@ -0,0 +1,313 @@
+//
+//  Po7_framing.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_framing.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+namespace
+   {
+    std::system_error FramingError( std::errc error )
+       {
+        return std::system_error( std::make_error_code( error ) );
+       }
+
+    // DecodePrefix reads the prefix at p, returning false if it hasn't all arrived before last.
+    bool DecodePrefix( Po7::frame_prefix_t prefix, const char *p, const char *last,
+                       std::size_t& prefixLength, std::uint64_t& messageLength )
+       {
+        const std::size_t available = static_cast< std::size_t >( last - p );
+        const unsigned char *bytes = reinterpret_cast< const unsigned char * >( p );
+
+        switch ( prefix )
+           {
+            case Po7::frame_prefix_t::varint:
+               {
+                std::uint64_t value = 0;
+
+                for ( std::size_t i = 0; i != Po7::max_frame_prefix; ++i )
+                   {
+                    if ( i == available )
+                        return false;
+
+                    if ( i == Po7::max_frame_prefix - 1 && bytes[i] > 1 )
+                        throw FramingError( std::errc::bad_message );       // more than 64 bits
+
+                    value |= std::uint64_t( bytes[i] & 0x7F ) << ( 7 * i );
+
+                    if ( ( bytes[i] & 0x80 ) == 0 )
+                       {
+                        prefixLength  = i + 1;
+                        messageLength = value;
+                        return true;
+                       }
+                   }
+
+                throw FramingError( std::errc::bad_message );
+               }
+
+            case Po7::frame_prefix_t::fixed16:
+                if ( available < 2 )
+                    return false;
+
+                prefixLength  = 2;
+                messageLength = std::uint64_t( bytes[0] ) << 8 | bytes[1];
+                return true;
+
+            case Po7::frame_prefix_t::fixed32:
+                if ( available < 4 )
+                    return false;
+
+                prefixLength  = 4;
+                messageLength = std::uint64_t( bytes[0] ) << 24 | std::uint64_t( bytes[1] ) << 16
+                              | std::uint64_t( bytes[2] ) << 8  | bytes[3];
+                return true;
+           }
+
+        throw std::invalid_argument( "Unknown frame prefix" );
+       }
+
+    iovec MakeVector( const char *data, std::size_t size )
+       {
+        iovec result;
+        result.iov_base = const_cast< char * >( data );
+        result.iov_len  = size;
+        return result;
+       }
+   }
+
+std::size_t Po7::encode_frame_prefix( frame_prefix_t prefix, std::uint64_t length, char *p )
+   {
+    switch ( prefix )
+       {
+        case frame_prefix_t::varint:
+           {
+            std::size_t n = 0;
+
+            while ( length >= 0x80 )
+               {
+                p[ n++ ] = static_cast< char >( ( length & 0x7F ) | 0x80 );
+                length >>= 7;
+               }
+
+            p[ n++ ] = static_cast< char >( length );
+            return n;
+           }
+
+        case frame_prefix_t::fixed16:
+            if ( length > 0xFFFF )
+                throw FramingError( std::errc::message_size );
+
+            p[0] = static_cast< char >( length >> 8 );
+            p[1] = static_cast< char >( length );
+            return 2;
+
+        case frame_prefix_t::fixed32:
+            if ( length > 0xFFFFFFFF )
+                throw FramingError( std::errc::message_size );
+
+            p[0] = static_cast< char >( length >> 24 );
+            p[1] = static_cast< char >( length >> 16 );
+            p[2] = static_cast< char >( length >> 8 );
+            p[3] = static_cast< char >( length );
+            return 4;
+       }
+
+    throw std::invalid_argument( "Unknown frame prefix" );
+   }
+
+// The range has already checked that every message in it is complete.
+void Po7::frame_iterator::Decode()
+   {
+    if ( position == last )
+       {
+        current = frame_view();
+        return;
+       }
+
+    std::size_t   prefixLength  = 0;
+    std::uint64_t messageLength = 0;
+
+    DecodePrefix( prefix, position, last, prefixLength, messageLength );
+    current = frame_view( position + prefixLength, static_cast< std::size_t >( messageLength ) );
+   }
+
+Po7::frame_reader::frame_reader( frame_prefix_t p, std::size_t maxMessage, std::size_t bufferSize )
+   : buffer( std::max( bufferSize, max_frame_prefix ) ),
+     prefix( p ),
+     limit( maxMessage )
+   {}
+
+void Po7::frame_reader::MakeRoom()
+   {
+    if ( consumed != 0 )
+       {
+        std::memmove( buffer.data(), buffer.data() + consumed, received - consumed );
+        received -= consumed;
+        consumed = 0;
+       }
+
+    // A message too large for the buffer makes the buffer larger, once its length is known.
+    std::size_t   prefixLength  = 0;
+    std::uint64_t messageLength = 0;
+
+    if ( DecodePrefix( prefix, buffer.data(), buffer.data() + received, prefixLength, messageLength ) )
+       {
+        if ( messageLength > limit )
+            throw FramingError( std::errc::message_size );
+
+        std::size_t needed = prefixLength + static_cast< std::size_t >( messageLength );
+        if ( needed > buffer.size() )
+            buffer.resize( needed );
+       }
+
+    if ( received == buffer.size() )
+        throw std::logic_error( "frame_reader is full of messages; call messages() before receiving more" );
+   }
+
+std::size_t Po7::frame_reader::receive( socket_t s )
+   {
+    MakeRoom();
+
+    std::size_t n = recv( s, buffer.data() + received, buffer.size() - received );
+    received += n;
+    return n;
+   }
+
+auto Po7::frame_reader::try_receive( socket_t s ) -> try_result
+   {
+    MakeRoom();
+
+    try_result result = try_recv( s, buffer.data() + received, buffer.size() - received );
+    received += result.size();
+    return result;
+   }
+
+auto Po7::frame_reader::messages() -> frame_range
+   {
+    const char *base = buffer.data();
+    std::size_t scan = consumed;
+
+    for (;;)
+       {
+        std::size_t   prefixLength  = 0;
+        std::uint64_t messageLength = 0;
+
+        if ( !DecodePrefix( prefix, base + scan, base + received, prefixLength, messageLength ) )
+            break;
+
+        if ( messageLength > limit )
+            throw FramingError( std::errc::message_size );
+
+        if ( messageLength > received - scan - prefixLength )
+            break;
+
+        scan += prefixLength + static_cast< std::size_t >( messageLength );
+       }
+
+    frame_range result( base + consumed, base + scan, prefix );
+    consumed = scan;
+    return result;
+   }
+
+Po7::frame_writer::frame_writer( frame_prefix_t p )
+   : prefix( p )
+   {}
+
+void Po7::frame_writer::add( const void *data, std::size_t size )
+   {
+    frame f;
+    f.prefixLength = encode_frame_prefix( prefix, size, f.prefix );
+    f.data         = static_cast< const char * >( data );
+    f.size         = size;
+
+    frames.push_back( f );
+   }
+
+// Gather describes what's left to send, picking up partway through the first frame if need be.
+// The iovecs are rebuilt for every call, since adding frames may move the prefixes.
+auto Po7::frame_writer::Gather() -> msghdr
+   {
+    vectors.clear();
+    std::size_t skip = partlySent;
+
+    for ( std::size_t i = firstUnsent; i != frames.size() && vectors.size() + 2 <= iov_max; ++i )
+       {
+        const frame& f = frames[i];
+
+        if ( skip < f.prefixLength )
+           {
+            vectors.push_back( MakeVector( f.prefix + skip, f.prefixLength - skip ) );
+            skip = 0;
+           }
+        else
+            skip -= f.prefixLength;
+
+        if ( skip < f.size )
+            vectors.push_back( MakeVector( f.data + skip, f.size - skip ) );
+
+        skip = 0;
+       }
+
+    return Make< msghdr >( vectors.data(), vectors.size() );
+   }
+
+void Po7::frame_writer::Advance( std::size_t sent )
+   {
+    while ( sent != 0 )
+       {
+        const frame& f = frames[ firstUnsent ];
+        std::size_t remaining = f.prefixLength + f.size - partlySent;
+
+        if ( sent < remaining )
+           {
+            partlySent += sent;
+            return;
+           }
+
+        sent -= remaining;
+        partlySent = 0;
+        ++firstUnsent;
+       }
+
+    // A writer that's added to between partial sends never empties, so the sent frames are dropped once
+    // they're numerous and at least half the vector; each frame is then moved a bounded number of times.
+    if ( firstUnsent == frames.size() )
+       {
+        frames.clear();
+        firstUnsent = 0;
+       }
+    else if ( firstUnsent >= 1024 && firstUnsent >= frames.size() - firstUnsent )
+       {
+        frames.erase( frames.begin(), frames.begin() + static_cast< std::ptrdiff_t >( firstUnsent ) );
+        firstUnsent = 0;
+       }
+   }
+
+void Po7::frame_writer::flush( socket_t s, msg_flags_t flags )
+   {
+    while ( !empty() )
+        Advance( sendmsg( s, Gather(), flags ) );
+   }
+
+bool Po7::frame_writer::try_flush( socket_t s, msg_flags_t flags )
+   {
+    while ( !empty() )
+       {
+        try_result result = try_sendmsg( s, Gather(), flags );
+        if ( result.would_block() )
+            return false;
+
+        Advance( result.size() );
+       }
+
+    return true;
+   }
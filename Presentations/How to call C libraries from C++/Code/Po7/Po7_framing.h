@@ -0,0 +1,209 @@
+//
+//  Po7_framing.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_FRAMING_H
+#define PO7_FRAMING_H
+
+#include "Po7_socket.h"
+#include "Po7_uio.h"
+
+#include "arraylike.h"
+#include "bufferlike.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+namespace Po7
+   {
+    // Framing divides a byte stream into messages, each preceded by its length.  frame_reader receives into a
+    // buffer it reuses, and hands out views of the messages in place; frame_writer sends a batch of messages,
+    // prefixes and all, with as few sendmsg calls as the socket allows.
+
+    // frame_prefix_t says how a message's length is written: varint is the base-128 form protocol buffers use,
+    // least significant group first, one to ten bytes; fixed16 and fixed32 are big-endian.
+        enum class frame_prefix_t { varint, fixed16, fixed32 };
+
+        const std::size_t max_frame_prefix = 10;
+
+    // encode_frame_prefix writes the prefix for a message of the given length, and returns its size.
+    // A length too large for a fixed prefix throws std::errc::message_size.
+        std::size_t encode_frame_prefix( frame_prefix_t, std::uint64_t length, char *prefix );
+
+
+    // frame_view refers to one message within a frame_reader's buffer.  It is arraylike, with char
+    // elements, and therefore bufferlike: a message can be sent on, or compared, without copying it.
+        class frame_view
+           {
+            private:
+                const char  *address;
+                std::size_t  length;
+
+            public:
+                frame_view()                                    : address( nullptr ), length( 0 ) {}
+                frame_view( const char *a, std::size_t n )      : address( a ), length( n ) {}
+
+                const char *data() const                        { return address; }
+                std::size_t size() const                        { return length; }
+                bool empty() const                              { return length == 0; }
+
+                const char *begin() const                       { return address; }
+                const char *end() const                         { return address + length; }
+           };
+
+        inline char const *arraylike_data( const frame_view& v )        { return v.data(); }
+        inline std::size_t arraylike_size( const frame_view& v )        { return v.size(); }
+
+    // frame_iterator walks the messages in a frame_range, decoding each prefix as it goes.
+        class frame_iterator
+           {
+            private:
+                const char      *position;
+                const char      *last;
+                frame_prefix_t   prefix;
+                frame_view       current;
+
+                void Decode();
+
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type        = frame_view;
+                using difference_type   = std::ptrdiff_t;
+                using pointer           = const frame_view *;
+                using reference         = const frame_view&;
+
+                frame_iterator()                                : position( nullptr ), last( nullptr ), prefix( frame_prefix_t::varint ) {}
+                frame_iterator( const char *p, const char *l, frame_prefix_t f )
+                   : position( p ), last( l ), prefix( f )      { Decode(); }
+
+                reference operator*() const                     { return current; }
+                pointer operator->() const                      { return &current; }
+
+                frame_iterator& operator++()                    { position = current.end(); Decode(); return *this; }
+                frame_iterator operator++( int )                { frame_iterator result = *this; ++*this; return result; }
+
+                friend bool operator==( const frame_iterator& a, const frame_iterator& b )  { return a.position == b.position; }
+                friend bool operator!=( const frame_iterator& a, const frame_iterator& b )  { return a.position != b.position; }
+           };
+
+    // frame_range is the complete messages from one call to frame_reader::messages, for a range-based for loop.
+        class frame_range
+           {
+            private:
+                const char      *first;
+                const char      *last;
+                frame_prefix_t   prefix;
+
+            public:
+                frame_range()                                   : first( nullptr ), last( nullptr ), prefix( frame_prefix_t::varint ) {}
+                frame_range( const char *f, const char *l, frame_prefix_t p )
+                   : first( f ), last( l ), prefix( p )         {}
+
+                frame_iterator begin() const                    { return frame_iterator( first, last, prefix ); }
+                frame_iterator end() const                      { return frame_iterator( last, last, prefix ); }
+                bool empty() const                              { return first == last; }
+           };
+
+
+    // frame_reader receives framed messages from a stream socket.  Each receive is one recv into the free end of
+    // the buffer; messages then takes every complete message received so far, as views into the buffer.  Those
+    // views stay valid until the next receive, which moves any partial message to the front of the buffer.
+    //
+    // The buffer grows to hold a message larger than itself, up to the reader's limit.  A longer message, or a
+    // malformed prefix, throws std::errc::message_size or std::errc::bad_message from messages or receive.
+        class frame_reader
+           {
+            private:
+                std::vector< char >     buffer;
+                std::size_t             consumed = 0;       // the start of the first message not yet handed out
+                std::size_t             received = 0;       // the end of the data received
+                frame_prefix_t          prefix;
+                std::size_t             limit;
+
+                void MakeRoom();
+
+            public:
+                explicit frame_reader( frame_prefix_t = frame_prefix_t::varint,
+                                       std::size_t maxMessage = 1 << 20,
+                                       std::size_t bufferSize = 1 << 16 );
+
+                frame_reader( const frame_reader& )             = delete;
+                frame_reader& operator=( const frame_reader& )  = delete;
+
+            // receive returns the number of bytes received, zero at end of stream.  try_receive is
+            // for non-blocking sockets, and says when the socket would block.
+                std::size_t receive( socket_t );
+                try_result try_receive( socket_t );
+
+            // messages consumes the complete messages waiting in the buffer, so each is returned only once.
+                frame_range messages();
+
+            // buffered is the number of bytes waiting that don't yet make a complete message.  If it isn't zero
+            // at end of stream, the peer stopped partway through a message.
+                std::size_t buffered() const                    { return received - consumed; }
+           };
+
+
+    // frame_writer gathers framed messages into sendmsg calls, up to iov_max buffers at a time.  It doesn't copy
+    // the messages: add keeps only their addresses, so they must stay put until they've been sent.  Only the
+    // prefixes are kept in the writer.  After a flush, the writer can be used again.
+        class frame_writer
+           {
+            private:
+                struct frame
+                   {
+                    char            prefix[ max_frame_prefix ];
+                    std::size_t     prefixLength;
+                    const char     *data;
+                    std::size_t     size;
+                   };
+
+                std::vector< frame >    frames;
+                std::vector< iovec >    vectors;
+                std::size_t             firstUnsent = 0;    // the first frame not entirely sent
+                std::size_t             partlySent  = 0;    // how much of it has been sent
+                frame_prefix_t          prefix;
+
+                msghdr Gather();
+                void Advance( std::size_t sent );
+
+            public:
+                explicit frame_writer( frame_prefix_t = frame_prefix_t::varint );
+
+                frame_writer( const frame_writer& )             = delete;
+                frame_writer& operator=( const frame_writer& )  = delete;
+
+                void add( const void *data, std::size_t size );
+
+                template < class Buffer >
+                auto add( const Buffer& b )
+                -> typename std::enable_if< PlusPlus::stdish::is_bufferlike<Buffer>::value >::type
+                   {
+                    add( PlusPlus::stdish::bufferlike_data( b ), PlusPlus::stdish::bufferlike_size( b ) );
+                   }
+
+                bool empty() const                              { return firstUnsent == frames.size(); }
+
+            // flush sends every waiting message.  try_flush, for non-blocking sockets, sends until the
+            // socket would block, and says whether everything has gone; it picks up where it stopped.
+                void flush( socket_t, msg_flags_t = msg_flags_t() );
+                bool try_flush( socket_t, msg_flags_t = msg_flags_t() );
+           };
+   }
+
+namespace PlusPlus
+   {
+    namespace stdish
+       {
+        template <> struct is_arraylike< Po7::frame_view >:            std::true_type {};
+        template <> struct arraylike_element_type< Po7::frame_view >   { using type = char; };
+       }
+   }
+
+#endif
@@ -0,0 +1,194 @@
+//
+//  Po7_happy_eyeballs.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_happy_eyeballs.h"
+#include "Po7_epoll.h"
+#include "Po7_fcntl.h"
+#include "Po7_sockopt.h"
+
+#include <algorithm>
+#include <cstring>
+
+using std::chrono::steady_clock;
+
+namespace
+   {
+    struct candidate
+       {
+        sockaddr_storage  address;
+        socklen_t         length;
+       };
+
+    template < class Address >
+    candidate MakeCandidate( const Address& a )
+       {
+        candidate c;
+        std::memset( &c.address, 0, sizeof( c.address ) );
+        std::memcpy( &c.address, &a, sizeof( a ) );
+        c.length = Po7::sockaddr_length( a );
+        return c;
+       }
+
+    // RFC 8305 alternates between the families, starting with IPv6.
+    std::vector< candidate > Interleave( const std::vector< sockaddr_in6 >& v6, const std::vector< sockaddr_in >& v4 )
+       {
+        std::vector< candidate > result;
+        result.reserve( v6.size() + v4.size() );
+
+        for ( std::size_t i = 0; i < std::max( v6.size(), v4.size() ); ++i )
+           {
+            if ( i < v6.size() )
+                result.push_back( MakeCandidate( v6[ i ] ) );
+            if ( i < v4.size() )
+                result.push_back( MakeCandidate( v4[ i ] ) );
+           }
+
+        return result;
+       }
+
+    // Round up, so a wait doesn't end just before the time it waits for.
+    std::chrono::milliseconds Until( steady_clock::time_point then, steady_clock::time_point now )
+       {
+        if ( then <= now )
+            return std::chrono::milliseconds( 0 );
+
+        steady_clock::duration     remaining = then - now;
+        std::chrono::milliseconds  wait      = std::chrono::duration_cast< std::chrono::milliseconds >( remaining );
+        if ( wait < remaining )
+            ++wait;
+
+        return wait;
+       }
+
+    Po7::unique_socket Connected( Po7::unique_socket s, Po7::socket_flags_t flags, std::error_code& error )
+       {
+        if ( ( flags & Po7::sock_nonblock ) != Po7::sock_nonblock )
+           {
+            Po7::open_flags_t status = Po7::fcntl_getfl( *s, error );
+
+            if ( !error )
+                Po7::fcntl_setfl( *s, status & ~Po7::o_nonblock, error );
+
+            if ( error )
+                return Po7::unique_socket();
+           }
+
+        return s;
+       }
+   }
+
+auto Po7::happy_eyeballs_connect( const std::vector< sockaddr_in6 >& v6,
+                                  const std::vector< sockaddr_in >&  v4,
+                                  steady_clock::time_point           deadline,
+                                  std::chrono::milliseconds          attemptDelay,
+                                  socket_flags_t                     flags,
+                                  std::error_code&                   error ) -> unique_socket
+   {
+    const std::vector< candidate > candidates = Interleave( v6, v4 );
+
+    if ( candidates.empty() )
+       {
+        error = std::make_error_code( std::errc::destination_address_required );
+        return unique_socket();
+       }
+
+    unique_epoll                 epoll = epoll_create1( epoll_cloexec, error );
+    if ( !epoll )
+        return unique_socket();
+
+    std::vector< unique_socket > attempts( candidates.size() );     // the losers are closed on the way out
+    std::size_t                  started   = 0;
+    std::size_t                  running   = 0;
+    std::error_code              lastError = std::make_error_code( std::errc::timed_out );
+    steady_clock::time_point     nextStart = steady_clock::now();
+
+    for (;;)
+       {
+        steady_clock::time_point now = steady_clock::now();
+
+        if ( now >= deadline )
+           {
+            lastError = std::make_error_code( std::errc::timed_out );
+            break;
+           }
+
+        if ( started < candidates.size() && ( now >= nextStart || running == 0 ) )
+           {
+            const std::size_t index = started++;
+            const candidate&  c     = candidates[ index ];
+
+            unique_socket s = socket( Wrap< socket_domain_t >( int( c.address.ss_family ) ),
+                                      sock_stream | sock_nonblock | ( flags & sock_cloexec ),
+                                      socket_protocol_t(),
+                                      lastError );
+            if ( !s )
+                continue;
+
+            bool immediate = try_connect( *s, sockaddr_cast< const sockaddr& >( c.address ), c.length, lastError );
+            if ( lastError )
+                continue;
+
+            if ( immediate )
+                return Connected( std::move( s ), flags, error );
+
+            epoll_event event = Make< epoll_event >( epollout, std::uint64_t( index ) );
+            epoll_ctl( *epoll, epoll_ctl_add, *s, event, lastError );
+            if ( lastError )
+                continue;
+
+            attempts[ index ] = std::move( s );
+            ++running;
+            nextStart = now + attemptDelay;
+            continue;
+           }
+
+        if ( running == 0 )
+            break;
+
+        steady_clock::time_point wake = started < candidates.size() ? std::min( deadline, nextStart ) : deadline;
+
+        epoll_event events[ 16 ];
+        std::size_t count = epoll_wait( *epoll, events, Until( wake, now ), error );     // zero when interrupted
+        if ( error )
+            return unique_socket();
+
+        for ( std::size_t i = 0; i < count; ++i )
+           {
+            unique_socket&  s      = attempts[ static_cast< std::size_t >( events[ i ].data.u64 ) ];
+            std::error_code result = getsockopt< so_error >( *s, lastError );
+
+            if ( !lastError && !result )
+                return Connected( std::move( s ), flags, error );
+
+            // A failure frees the race to start the next attempt without waiting out the delay.  Closing the
+            // socket takes it out of the epoll set.
+            if ( result )
+                lastError = result;
+            s.reset();
+            --running;
+            nextStart = steady_clock::now();
+           }
+       }
+
+    error = lastError;
+    return unique_socket();
+   }
+
+auto Po7::happy_eyeballs_connect( const std::vector< sockaddr_in6 >& v6,
+                                  const std::vector< sockaddr_in >&  v4,
+                                  steady_clock::time_point           deadline,
+                                  std::chrono::milliseconds          attemptDelay,
+                                  socket_flags_t                     flags ) -> unique_socket
+   {
+    std::error_code error;
+    unique_socket result = happy_eyeballs_connect( v6, v4, deadline, attemptDelay, flags, error );
+
+    if ( error )
+        throw std::system_error( error, "happy_eyeballs_connect" );
+
+    return result;
+   }
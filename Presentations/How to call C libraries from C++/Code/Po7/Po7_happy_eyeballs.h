@@ -0,0 +1,47 @@
+//
+//  Po7_happy_eyeballs.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_HAPPY_EYEBALLS_H
+#define PO7_HAPPY_EYEBALLS_H
+
+#include "Po7_in.h"
+#include "Po7_socket.h"
+
+#include <chrono>
+#include <system_error>
+#include <vector>
+
+namespace Po7
+   {
+    // happy_eyeballs_connect connects a stream socket to whichever of a host's addresses answers first, in the
+    // manner of RFC 8305.  The addresses are tried alternately, IPv6 first.  Each attempt gets attemptDelay to
+    // succeed before the next one starts alongside it; an attempt that fails starts the next one at once.
+    // When one connects, the others are closed.  A host whose IPv6 route is broken thus costs a
+    // quarter second, not a full connect timeout.
+    //
+    // The whole race ends by the deadline: if nothing has connected by then, the error is
+    // std::errc::timed_out.  If every attempt fails sooner, the error is the last one's.
+    //
+    // The attempts are non-blocking, but the call waits for the race to finish.  The socket it returns is
+    // blocking unless flags includes sock_nonblock.
+        unique_socket happy_eyeballs_connect( const std::vector< sockaddr_in6 >&,
+                                              const std::vector< sockaddr_in >&,
+                                              std::chrono::steady_clock::time_point deadline,
+                                              std::chrono::milliseconds attemptDelay = std::chrono::milliseconds( 250 ),
+                                              socket_flags_t flags = sock_cloexec );
+
+    // This form reports connection failures, the deadline, and any other system error through the error_code,
+    // returning a null socket.
+        unique_socket happy_eyeballs_connect( const std::vector< sockaddr_in6 >&,
+                                              const std::vector< sockaddr_in >&,
+                                              std::chrono::steady_clock::time_point deadline,
+                                              std::chrono::milliseconds attemptDelay,
+                                              socket_flags_t flags,
+                                              std::error_code& );
+   }
+
+#endif
@@ -9,8 +9,12 @@
 #include "Po7_in.h"
 #include "Po7_inet.h"
 
+#include <algorithm>
+#include <cstring>
 #include <istream>
+#include <limits>
 #include <ostream>
+#include <stdexcept>
 #include <string>
 #include <arpa/inet.h>
 
@@ -77,9 +81,8 @@ auto Po7::MakeAnything( ThingToMake< in_addr_t >, const std::string& s ) -> in_a
 
 auto Po7::MakeAnything( ThingToMake< std::string >, in_addr_t address ) -> std::string
    {
-    char text[ inet_addr_string_length< af_inet >::value ];
-    inet_ntop< af_inet >( address, text );
-    return std::string( text );
+    char text[ format_length< in_addr_t >::value ];
+    return std::string( text, format_to( text, address ) );
    }
 
 std::ostream& Po7::operator<<( std::ostream& stream, in_addr_t address )
@@ -129,8 +132,9 @@ sockaddr_in Po7::MakeAnything( ThingToMake< sockaddr_in >, const in_addr& addres
     sockaddr_in result;
     memset( &result, 0, sizeof( result ) );
     
-    result.sin_addr = address;
-    result.sin_port = Unwrap( port );
+    result.sin_family = AF_INET;
+    result.sin_addr   = address;
+    result.sin_port   = Unwrap( port );
     
     return result;
    }
@@ -142,19 +146,19 @@ sockaddr_in Po7::MakeAnything( ThingToMake< sockaddr_in >, in_addr_t address, in
 
 sockaddr_in Po7::MakeAnything( ThingToMake< sockaddr_in >, const std::string& text )
    {
-    std::string::const_iterator afterLastColon = std::find( text.rbegin(), text.rend(), ':' ).base();
-    if ( afterLastColon == text.begin() )
+    sockaddr_in result;
+    const char *end = text.data() + text.size();
+    
+    if ( parse( text.data(), end, result ) != end )
         throw std::domain_error( "Invalid IP4 socket address" );
     
-    return Make< sockaddr_in >( Make< in_addr_t >( std::string( text.begin(),   afterLastColon - 1 ) ),
-                                Make< in_port_t >( std::string( afterLastColon, text.end() ) ) );
+    return result;
    }
 
 std::string Po7::MakeAnything( ThingToMake< std::string >, const sockaddr_in& address )
    {
-    return Make< std::string >( address.sin_addr )
-           + ":"
-           + Make< std::string >( Wrap< in_port_t >( address.sin_port ) );
+    char text[ format_length< sockaddr_in >::value ];
+    return std::string( text, format_to( text, address ) );
    }
 
 
@@ -168,9 +172,8 @@ in6_addr Po7::MakeAnything( ThingToMake< in6_addr >, const std::string& s )
 
 std::string Po7::MakeAnything( ThingToMake< std::string >, const ::in6_addr& address )
    {
-    char text[ inet_addr_string_length< af_inet6 >::value ];
-    inet_ntop< af_inet6 >( address, text );
-    return std::string( text );
+    char text[ format_length< in6_addr >::value ];
+    return std::string( text, format_to( text, address ) );
    }
 
 
@@ -182,29 +185,394 @@ sockaddr_in6 Po7::MakeAnything( ThingToMake< sockaddr_in6 >, const in6_addr& add
     sockaddr_in6 result;
     memset( &result, 0, sizeof( result ) );
     
-    result.sin6_addr = address;
-    result.sin6_port = Unwrap( port );
+    result.sin6_family = AF_INET6;
+    result.sin6_addr   = address;
+    result.sin6_port   = Unwrap( port );
     
     return result;
    }
 
 sockaddr_in6 Po7::MakeAnything( ThingToMake< sockaddr_in6 >, const std::string& text )
    {
-    std::string::const_iterator afterLastColon = std::find( text.rbegin(), text.rend(), ':' ).base();
+    sockaddr_in6 result;
+    const char *end = text.data() + text.size();
     
-    if ( afterLastColon - text.begin() < 3
-         || text.front() != '['
-         || *(afterLastColon - 2) != ']' )
+    if ( parse( text.data(), end, result ) != end )
         throw std::domain_error( "Invalid IP6 socket address" );
     
-    return Make< sockaddr_in6 >( Make< in6_addr  >( std::string( text.begin() + 1, afterLastColon - 2 ) ),
-                                 Make< in_port_t >( std::string( afterLastColon,   text.end() ) ) );
+    return result;
    }
 
 std::string Po7::MakeAnything( ThingToMake< std::string >, const sockaddr_in6& address )
    {
-    return "["
-           + Make< std::string >( address.sin6_addr )
-           + "]:"
-           + Make< std::string >( Wrap< in_port_t >( address.sin6_port ) );
+    char text[ format_length< sockaddr_in6 >::value ];
+    return std::string( text, format_to( text, address ) );
+   }
+
+
+
+// Text conversion without allocation.  Addresses are at most a few dozen characters, so these work a character
+// at a time, without locale lookups or the setup cost of vector loads.
+
+namespace
+   {
+    inline bool IsDigit( char c )                   { return static_cast< unsigned char >( c - '0' ) < 10; }
+
+    inline int HexValue( char c )
+       {
+        if ( IsDigit( c ) )
+            return c - '0';
+        
+        const unsigned char lower = static_cast< unsigned char >( ( c | 0x20 ) - 'a' );
+        return lower < 6 ? lower + 10 : -1;
+       }
+
+    char *FormatDecimal( char *out, unsigned value )
+       {
+        char digits[ 10 ];
+        char *first = digits + sizeof( digits );
+        
+        do
+           {
+            *--first = char( '0' + value % 10 );
+            value /= 10;
+           }
+        while ( value != 0 );
+        
+        return std::copy( first, digits + sizeof( digits ), out );
+       }
+
+    char *FormatOctets( char *out, const unsigned char *octets )
+       {
+        for ( int i = 0; i < 4; ++i )
+           {
+            if ( i != 0 )
+                *out++ = '.';
+            
+            const unsigned octet = octets[i];
+            
+            if ( octet >= 100 )
+                *out++ = char( '0' + octet / 100 );
+            if ( octet >= 10 )
+                *out++ = char( '0' + octet / 10 % 10 );
+            *out++ = char( '0' + octet % 10 );
+           }
+        
+        return out;
+       }
+
+    char *FormatHexGroup( char *out, unsigned group )
+       {
+        static const char hex[] = "0123456789abcdef";
+        
+        if ( group >= 0x1000 )
+            *out++ = hex[ group >> 12 ];
+        if ( group >= 0x100 )
+            *out++ = hex[ group >> 8 & 0xF ];
+        if ( group >= 0x10 )
+            *out++ = hex[ group >> 4 & 0xF ];
+        *out++ = hex[ group & 0xF ];
+        
+        return out;
+       }
+
+    // Like inet_pton, this accepts exactly four decimal octets without leading zeros.
+    const char *ParseOctets( const char *p, const char *end, unsigned char *octets )
+       {
+        for ( int i = 0; i < 4; ++i )
+           {
+            if ( i != 0 )
+               {
+                if ( p == end || *p != '.' )
+                    return nullptr;
+                ++p;
+               }
+            
+            if ( p == end || !IsDigit( *p ) )
+                return nullptr;
+            
+            unsigned value = unsigned( *p++ - '0' );
+            
+            if ( value != 0 )
+                for ( int digits = 1; digits < 3 && p != end && IsDigit( *p ); ++digits )
+                    value = value * 10 + unsigned( *p++ - '0' );
+            
+            if ( value > 255 )
+                return nullptr;
+            
+            octets[i] = static_cast< unsigned char >( value );
+           }
+        
+        return p;
+       }
+
+    const char *ParseIn6Bytes( const char *p, const char *end, unsigned char *bytes )
+       {
+        std::memset( bytes, 0, 16 );
+        
+        int used = 0;
+        int gap  = -1;
+        
+        if ( p != end && *p == ':' )
+           {
+            if ( end - p < 2 || p[1] != ':' )
+                return nullptr;
+            
+            gap = 0;
+            p += 2;
+            
+            if ( p == end || HexValue( *p ) < 0 )
+                return p;
+           }
+        
+        for (;;)
+           {
+            const char *groupStart = p;
+            unsigned group = 0;
+            int digits = 0;
+            
+            for ( int value; p != end && ( value = HexValue( *p ) ) >= 0; ++p )
+               {
+                if ( ++digits > 4 )
+                    return nullptr;
+                group = group << 4 | unsigned( value );
+               }
+            
+            if ( digits == 0 )
+                return nullptr;
+            
+            if ( p != end && *p == '.' )
+               {
+                if ( used > 12 )
+                    return nullptr;
+                
+                p = ParseOctets( groupStart, end, bytes + used );
+                if ( p == nullptr )
+                    return nullptr;
+                
+                used += 4;
+                break;
+               }
+            
+            if ( used == 16 )
+                return nullptr;
+            
+            bytes[ used++ ] = static_cast< unsigned char >( group >> 8 );
+            bytes[ used++ ] = static_cast< unsigned char >( group );
+            
+            if ( p == end || *p != ':' )
+                break;
+            
+            if ( end - p >= 2 && p[1] == ':' )
+               {
+                if ( gap >= 0 )
+                    return nullptr;
+                
+                gap = used;
+                p += 2;
+                
+                if ( p == end || HexValue( *p ) < 0 )
+                    break;
+               }
+            else
+               {
+                ++p;
+                
+                if ( p == end || HexValue( *p ) < 0 )
+                    return nullptr;
+               }
+           }
+        
+        if ( gap < 0 )
+            return used == 16 ? p : nullptr;
+        
+        if ( used == 16 )
+            return nullptr;
+        
+        // Move what follows the gap to the end.
+        const int tail = used - gap;
+        std::memmove( bytes + 16 - tail, bytes + gap, tail );
+        std::memset( bytes + gap, 0, 16 - tail - gap );
+        
+        return p;
+       }
+
+    // Ports are written in decimal, up to 65535.
+    const char *ParsePort( const char *p, const char *end, Po7::in_port_number& port )
+       {
+        unsigned long value = 0;
+        int digits = 0;
+        
+        for ( ; p != end && IsDigit( *p ); ++p )
+           {
+            if ( ++digits > 5 )
+                return nullptr;
+            value = value * 10 + unsigned( *p - '0' );
+           }
+        
+        if ( digits == 0 || value > 65535 )
+            return nullptr;
+        
+        port = static_cast< Po7::in_port_number >( value );
+        return p;
+       }
+   }
+
+char *Po7::format_to( char *out, in_port_t port )
+   {
+    return FormatDecimal( out, Make< in_port_number >( port ) );
+   }
+
+char *Po7::format_to( char *out, in_addr_t address )
+   {
+    const ::in_addr_t raw = Unwrap( address );
+    return FormatOctets( out, reinterpret_cast< const unsigned char * >( &raw ) );
+   }
+
+char *Po7::format_to( char *out, const in6_addr& address )
+   {
+    const unsigned char *bytes = address.s6_addr;
+    
+    unsigned groups[ 8 ];
+    for ( int i = 0; i < 8; ++i )
+        groups[i] = unsigned( bytes[ 2*i ] ) << 8 | bytes[ 2*i + 1 ];
+    
+    // Find the first longest run of two or more zero groups, to write as "::".
+    int bestStart = -1, bestLength = 0;
+    
+    for ( int i = 0; i < 8; )
+       {
+        if ( groups[i] != 0 )
+           {
+            ++i;
+            continue;
+           }
+        
+        int j = i;
+        while ( j < 8 && groups[j] == 0 )
+            ++j;
+        
+        if ( j - i > bestLength )
+           {
+            bestStart  = i;
+            bestLength = j - i;
+           }
+        
+        i = j;
+       }
+    
+    if ( bestLength < 2 )
+        bestStart = -1;
+    
+    for ( int i = 0; i < 8; ++i )
+       {
+        if ( bestStart >= 0 && i >= bestStart && i < bestStart + bestLength )
+           {
+            if ( i == bestStart )
+                *out++ = ':';
+            continue;
+           }
+        
+        if ( i != 0 )
+            *out++ = ':';
+        
+        // Like inet_ntop, write IPv4-compatible and IPv4-mapped addresses with a dotted quad.
+        if ( i == 6 && bestStart == 0 && ( bestLength == 6 || ( bestLength == 5 && groups[5] == 0xFFFF ) ) )
+            return FormatOctets( out, bytes + 12 );
+        
+        out = FormatHexGroup( out, groups[i] );
+       }
+    
+    if ( bestStart >= 0 && bestStart + bestLength == 8 )
+        *out++ = ':';
+    
+    return out;
+   }
+
+char *Po7::format_to( char *out, const sockaddr_in& address )
+   {
+    out = format_to( out, Wrap< in_addr_t >( address.sin_addr.s_addr ) );
+    *out++ = ':';
+    return format_to( out, Wrap< in_port_t >( address.sin_port ) );
+   }
+
+char *Po7::format_to( char *out, const sockaddr_in6& address )
+   {
+    *out++ = '[';
+    out = format_to( out, address.sin6_addr );
+    *out++ = ']';
+    *out++ = ':';
+    return format_to( out, Wrap< in_port_t >( address.sin6_port ) );
+   }
+
+const char *Po7::parse( const char *begin, const char *end, in_port_t& port )
+   {
+    in_port_number number;
+    const char *p = ParsePort( begin, end, number );
+    
+    if ( p != nullptr )
+        port = Make< in_port_t >( number );
+    
+    return p;
+   }
+
+const char *Po7::parse( const char *begin, const char *end, in_addr_t& address )
+   {
+    ::in_addr_t raw;
+    const char *p = ParseOctets( begin, end, reinterpret_cast< unsigned char * >( &raw ) );
+    
+    if ( p != nullptr )
+        address = Wrap< in_addr_t >( raw );
+    
+    return p;
+   }
+
+const char *Po7::parse( const char *begin, const char *end, in6_addr& address )
+   {
+    unsigned char bytes[ 16 ];
+    const char *p = ParseIn6Bytes( begin, end, bytes );
+    
+    if ( p != nullptr )
+        std::memcpy( address.s6_addr, bytes, 16 );
+    
+    return p;
+   }
+
+const char *Po7::parse( const char *begin, const char *end, sockaddr_in& result )
+   {
+    in_addr_t address;
+    in_port_t port;
+    
+    const char *p = parse( begin, end, address );
+    
+    if ( p == nullptr || p == end || *p != ':' )
+        return nullptr;
+    
+    p = parse( p + 1, end, port );
+    
+    if ( p != nullptr )
+        result = Make< sockaddr_in >( address, port );
+    
+    return p;
+   }
+
+const char *Po7::parse( const char *begin, const char *end, sockaddr_in6& result )
+   {
+    in6_addr address;
+    in_port_t port;
+    
+    if ( begin == end || *begin != '[' )
+        return nullptr;
+    
+    const char *p = parse( begin + 1, end, address );
+    
+    if ( p == nullptr || end - p < 2 || p[0] != ']' || p[1] != ':' )
+        return nullptr;
+    
+    p = parse( p + 2, end, port );
+    
+    if ( p != nullptr )
+        result = Make< sockaddr_in6 >( address, port );
+    
+    return p;
    }
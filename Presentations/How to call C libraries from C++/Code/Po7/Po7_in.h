@@ -12,6 +12,11 @@
 #include "Po7_Basics.h"
 #include "Po7_is_sockaddr.h"
 
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
 #include <netinet/in.h>
 
 namespace Po7
@@ -89,6 +94,60 @@ namespace Po7
     
         sockaddr_in6 MakeAnything( ThingToMake< sockaddr_in6 >, const std::string&  );
         std::string  MakeAnything( ThingToMake< std::string  >, const sockaddr_in6& );
+
+
+    // format_to and parse convert addresses to and from text without allocating, for code that converts
+    // an address for every connection, like logging and access checks.
+    //
+    // format_to writes the same text as Make< std::string >, starting at out, and returns the end of what it
+    // wrote.  It doesn't write a terminating NUL; format_length<T> is the most it writes.
+        template < class T > struct format_length;
+
+        template <> struct format_length< in_port_t    >: std::integral_constant< std::size_t, 5  > {};
+        template <> struct format_length< in_addr_t    >: std::integral_constant< std::size_t, 15 > {};
+        template <> struct format_length< in6_addr     >: std::integral_constant< std::size_t, 45 > {};
+        template <> struct format_length< sockaddr_in  >: std::integral_constant< std::size_t, 21 > {};
+        template <> struct format_length< sockaddr_in6 >: std::integral_constant< std::size_t, 53 > {};
+
+        char *format_to( char *out, in_port_t );
+        char *format_to( char *out, in_addr_t );
+        char *format_to( char *out, const in6_addr& );
+        char *format_to( char *out, const sockaddr_in& );
+        char *format_to( char *out, const sockaddr_in6& );
+
+    // parse reads an address from the start of [begin, end), and returns the end of what it read, or nullptr if
+    // the text doesn't start with one.  It accepts what inet_pton accepts, and socket addresses in the forms
+    // Make< std::string > writes.
+        const char *parse( const char *begin, const char *end, in_port_t&    );
+        const char *parse( const char *begin, const char *end, in_addr_t&    );
+        const char *parse( const char *begin, const char *end, in6_addr&     );
+        const char *parse( const char *begin, const char *end, sockaddr_in&  );
+        const char *parse( const char *begin, const char *end, sockaddr_in6& );
+
+    // format_each writes NUL-terminated text for count values into rows of a table.  parse_each reads count
+    // NUL-terminated strings, and returns how many it converted before reaching one that isn't wholly an address.
+        template < class T > using format_row = char[ format_length< T >::value + 1 ];
+
+        template < class T >
+        void format_each( const T *values, std::size_t count, format_row< T > *rows )
+           {
+            for ( std::size_t i = 0; i < count; ++i )
+                *format_to( rows[i], values[i] ) = '\0';
+           }
+
+        template < class T >
+        std::size_t parse_each( const char *const *texts, std::size_t count, T *values )
+           {
+            for ( std::size_t i = 0; i < count; ++i )
+               {
+                const char *end = texts[i] + std::strlen( texts[i] );
+
+                if ( parse( texts[i], end, values[i] ) != end )
+                    return i;
+               }
+
+            return count;
+           }
    }
 
 #endif
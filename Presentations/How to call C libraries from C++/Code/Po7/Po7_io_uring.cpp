@@ -0,0 +1,463 @@
+//
+//  Po7_io_uring.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_io_uring.h"
+#include "Po7_ResultGroups.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+namespace
+   {
+    // glibc doesn't declare the io_uring calls, so these give them ordinary signatures for Invoke.
+
+    int SystemIoUringSetup( unsigned entries, io_uring_params *params )
+       {
+        return static_cast< int >( ::syscall( __NR_io_uring_setup, entries, params ) );
+       }
+
+    int SystemIoUringEnter( int fd, unsigned toSubmit, unsigned minimumCompletions, unsigned flags )
+       {
+        return static_cast< int >( ::syscall( __NR_io_uring_enter, fd, toSubmit, minimumCompletions, flags, nullptr, 0 ) );
+       }
+
+    int SystemIoUringRegister( int fd, unsigned opcode, void *argument, unsigned count )
+       {
+        return static_cast< int >( ::syscall( __NR_io_uring_register, fd, opcode, argument, count ) );
+       }
+
+    // A completion carries what the call would have returned, or a negated errno.  CompletedCall turns it
+    // back into a return value and errno, so the usual result groups can interpret it.
+    int CompletedCall( int result )
+       {
+        if ( result >= 0 )
+            return result;
+
+        errno = -result;
+        return -1;
+       }
+
+    template < class ResultGroup, class Value >
+    void InterpretCompletion( ResultGroup group, int result, Value& value, std::error_code& error )
+       {
+        value = Po7::Invoke( std::move( group ), CompletedCall, Po7::In( result ), Po7::ReportErrorFromErrno( error ) );
+       }
+
+    template < class ResultGroup >
+    void InterpretCompletion( ResultGroup group, int result, std::error_code& error )
+       {
+        Po7::Invoke( std::move( group ), CompletedCall, Po7::In( result ), Po7::ReportErrorFromErrno( error ) );
+       }
+
+    struct MapFailed
+       {
+        bool operator()( void *p ) const                                    { return p == MAP_FAILED; }
+       };
+
+    void *Map( Po7::fd_t fd, std::size_t length, ::off_t offset )
+       {
+        return Po7::Invoke( Po7::Result< void * >() + Po7::FailsWhen( MapFailed() ),
+                            ::mmap,
+                            Po7::In( nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset ),
+                            Po7::ThrowErrorFromErrno() );
+       }
+
+    void *MapAnonymous( std::size_t length )
+       {
+        return Po7::Invoke( Po7::Result< void * >() + Po7::FailsWhen( MapFailed() ),
+                            ::mmap,
+                            Po7::In( nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, ::off_t( 0 ) ),
+                            Po7::ThrowErrorFromErrno() );
+       }
+
+    // A request's length is 32 bits.  A longer transfer is cut short, as the kernel would cut it anyway;
+    // the handler sees how much was done, as it would after a short send or recv.
+    std::uint32_t TransferLength( std::size_t length )
+       {
+        return static_cast< std::uint32_t >( std::min< std::size_t >( length, std::numeric_limits< std::uint32_t >::max() ) );
+       }
+
+    template < class T >
+    T *At( void *base, std::uint32_t offset )
+       {
+        return reinterpret_cast< T * >( static_cast< char * >( base ) + offset );
+       }
+
+    // The rings are shared with the kernel, which reads what we write after a release store,
+    // and writes what we read before an acquire load.
+    unsigned LoadAcquire( const unsigned *p )                               { return __atomic_load_n( p, __ATOMIC_ACQUIRE ); }
+    void StoreRelease( unsigned *p, unsigned v )                            { __atomic_store_n( p, v, __ATOMIC_RELEASE ); }
+    void StoreRelease( std::uint16_t *p, std::uint16_t v )                  { __atomic_store_n( p, v, __ATOMIC_RELEASE ); }
+   }
+
+void Po7::ring::MappingDeleter::operator()( void *p ) const
+   {
+    // Don't use Invoke in the deleter; this must ignore errors
+
+    ::munmap( p, length );
+   }
+
+Po7::ring::ring( unsigned entries )
+   {
+    io_uring_params params;
+    std::memset( &params, 0, sizeof( params ) );
+    params.flags = IORING_SETUP_CLAMP;
+
+    descriptor = Invoke( Result< unique_fd >() + FailsWhenFalse(),
+                         SystemIoUringSetup,
+                         In( entries ),
+                         InOut( params ),
+                         ThrowErrorFromErrno() );
+
+    if ( !( params.features & IORING_FEAT_SINGLE_MMAP ) )
+        throw std::runtime_error( "io_uring is too old: it needs IORING_FEAT_SINGLE_MMAP" );
+
+    std::size_t submissionRingSize = params.sq_off.array + params.sq_entries * sizeof( unsigned );
+    std::size_t completionRingSize = params.cq_off.cqes  + params.cq_entries * sizeof( io_uring_cqe );
+    std::size_t ringSize           = std::max( submissionRingSize, completionRingSize );
+    std::size_t submissionsSize    = params.sq_entries * sizeof( io_uring_sqe );
+
+    rings       = mapping( Map( *descriptor, ringSize, IORING_OFF_SQ_RING ), MappingDeleter{ ringSize } );
+    submissions = mapping( Map( *descriptor, submissionsSize, IORING_OFF_SQES ), MappingDeleter{ submissionsSize } );
+
+    submissionHead       = At< unsigned >( rings.get(), params.sq_off.head );
+    submissionTail       = At< unsigned >( rings.get(), params.sq_off.tail );
+    submissionMask       = *At< unsigned >( rings.get(), params.sq_off.ring_mask );
+    submissionEntries    = params.sq_entries;
+    submissionEntryArray = static_cast< io_uring_sqe * >( submissions.get() );
+
+    completionHead       = At< unsigned >( rings.get(), params.cq_off.head );
+    completionTail       = At< unsigned >( rings.get(), params.cq_off.tail );
+    completionMask       = *At< unsigned >( rings.get(), params.cq_off.ring_mask );
+    completionEntryArray = At< io_uring_cqe >( rings.get(), params.cq_off.cqes );
+
+    // Slot i of the submission ring always names entry i, so queuing only needs to fill in the entry.
+    unsigned *indexArray = At< unsigned >( rings.get(), params.sq_off.array );
+    for ( unsigned i = 0; i < submissionEntries; ++i )
+        indexArray[ i ] = i;
+
+    queuedTail = *submissionTail;
+   }
+
+std::uint32_t Po7::ring::NewOperation( operation_kind kind )
+   {
+    std::uint32_t index;
+
+    if ( freeOperations.empty() )
+       {
+        index = static_cast< std::uint32_t >( operations.size() );
+        operations.emplace_back();
+       }
+    else
+       {
+        index = freeOperations.back();
+        freeOperations.pop_back();
+       }
+
+    operations[ index ].kind = kind;
+    return index;
+   }
+
+auto Po7::ring::Prepare( std::uint8_t opcode, int fd, bool fixed ) -> io_uring_sqe&
+   {
+    if ( queuedTail - LoadAcquire( submissionHead ) >= submissionEntries )
+        submit();
+
+    if ( queuedTail - LoadAcquire( submissionHead ) >= submissionEntries )
+        throw std::length_error( "io_uring submission queue is full" );
+
+    io_uring_sqe& entry = submissionEntryArray[ queuedTail & submissionMask ];
+    std::memset( &entry, 0, sizeof( entry ) );
+
+    entry.opcode    = opcode;
+    entry.fd        = fd;
+    entry.flags     = fixed ? IOSQE_FIXED_FILE : 0;
+
+    return entry;
+   }
+
+void Po7::ring::QueueAccept( int fd, bool fixed, socket_flags_t flags, accept_handler h )
+   {
+    io_uring_sqe& entry = Prepare( IORING_OP_ACCEPT, fd, fixed );
+    std::uint32_t index = NewOperation( operation_kind::accept );
+    entry.user_data     = index;
+    entry.accept_flags  = static_cast< std::uint32_t >( Unwrap( flags ) );
+
+    operations[ index ].onAccept = std::move( h );
+    StoreRelease( submissionTail, ++queuedTail );
+    ++unsubmitted;
+    ++inFlight;
+   }
+
+void Po7::ring::QueueRecv( int fd, bool fixed, void *buffer, std::size_t length, msg_flags_t flags, transfer_handler h )
+   {
+    io_uring_sqe& entry = Prepare( IORING_OP_RECV, fd, fixed );
+    std::uint32_t index = NewOperation( operation_kind::transfer );
+    entry.user_data     = index;
+    entry.addr          = reinterpret_cast< std::uintptr_t >( buffer );
+    entry.len           = TransferLength( length );
+    entry.msg_flags     = static_cast< std::uint32_t >( Unwrap( flags ) );
+
+    operations[ index ].onTransfer = std::move( h );
+    StoreRelease( submissionTail, ++queuedTail );
+    ++unsubmitted;
+    ++inFlight;
+   }
+
+void Po7::ring::QueueRecv( int fd, bool fixed, buffer_group_t group, msg_flags_t flags, buffer_handler h )
+   {
+    std::uint16_t groupID = Unwrap( group );
+    if ( groupID >= bufferGroups.size() )
+        throw std::invalid_argument( "No such buffer group" );
+
+    io_uring_sqe& entry = Prepare( IORING_OP_RECV, fd, fixed );
+    std::uint32_t index = NewOperation( operation_kind::buffer );
+    entry.user_data     = index;
+    entry.flags        |= IOSQE_BUFFER_SELECT;
+    entry.buf_group     = groupID;
+    entry.msg_flags     = static_cast< std::uint32_t >( Unwrap( flags ) );
+
+    operations[ index ].group    = groupID;
+    operations[ index ].onBuffer = std::move( h );
+    StoreRelease( submissionTail, ++queuedTail );
+    ++unsubmitted;
+    ++inFlight;
+   }
+
+void Po7::ring::QueueSend( int fd, bool fixed, const void *buffer, std::size_t length, msg_flags_t flags, transfer_handler h )
+   {
+    io_uring_sqe& entry = Prepare( IORING_OP_SEND, fd, fixed );
+    std::uint32_t index = NewOperation( operation_kind::transfer );
+    entry.user_data     = index;
+    entry.addr          = reinterpret_cast< std::uintptr_t >( buffer );
+    entry.len           = TransferLength( length );
+    entry.msg_flags     = static_cast< std::uint32_t >( Unwrap( flags ) );
+
+    operations[ index ].onTransfer = std::move( h );
+    StoreRelease( submissionTail, ++queuedTail );
+    ++unsubmitted;
+    ++inFlight;
+   }
+
+void Po7::ring::close( unique_socket s, close_handler h )
+   {
+    io_uring_sqe& entry = Prepare( IORING_OP_CLOSE, Unwrap( *s ), false );
+    std::uint32_t index = NewOperation( operation_kind::close );
+    entry.user_data     = index;
+    Release( std::move( s ) );
+
+    operations[ index ].onClose = std::move( h );
+    StoreRelease( submissionTail, ++queuedTail );
+    ++unsubmitted;
+    ++inFlight;
+   }
+
+void Po7::ring::register_files( unsigned count )
+   {
+    std::vector< int > empty( count, -1 );
+
+    Invoke( FailureFlagResult<int>(),
+            SystemIoUringRegister,
+            In( *descriptor, unsigned( IORING_REGISTER_FILES ), static_cast< void * >( empty.data() ), count ),
+            ThrowErrorFromErrno() );
+   }
+
+void Po7::ring::register_file( fixed_file_t slot, fd_t fd )
+   {
+    int fds[ 1 ] = { Unwrap( fd ) };
+
+    io_uring_files_update update;
+    std::memset( &update, 0, sizeof( update ) );
+    update.offset = Unwrap( slot );
+    update.fds    = reinterpret_cast< std::uintptr_t >( fds );
+
+    // This one returns the number of slots updated.
+    Invoke( int_CountResult(),
+            SystemIoUringRegister,
+            In( *descriptor, unsigned( IORING_REGISTER_FILES_UPDATE ), static_cast< void * >( &update ), 1u ),
+            ThrowErrorFromErrno() );
+   }
+
+auto Po7::ring::provide_buffers( std::uint16_t count, std::size_t size ) -> buffer_group_t
+   {
+    if ( count == 0 || ( count & ( count - 1 ) ) != 0 )
+        throw std::invalid_argument( "The number of buffers must be a power of two" );
+
+    std::uint16_t groupID = static_cast< std::uint16_t >( bufferGroups.size() );
+    std::size_t entriesSize = count * sizeof( io_uring_buf );
+
+    buffer_group group;
+    group.entries    = mapping( MapAnonymous( entriesSize ), MappingDeleter{ entriesSize } );
+    group.storage    = std::unique_ptr< char[] >( new char[ count * size ] );
+    group.bufferSize = size;
+    group.mask       = static_cast< std::uint16_t >( count - 1 );
+    group.tail       = 0;
+
+    io_uring_buf_reg registration;
+    std::memset( &registration, 0, sizeof( registration ) );
+    registration.ring_addr    = reinterpret_cast< std::uintptr_t >( group.entries.get() );
+    registration.ring_entries = count;
+    registration.bgid         = groupID;
+
+    Invoke( FailureFlagResult<int>(),
+            SystemIoUringRegister,
+            In( *descriptor, unsigned( IORING_REGISTER_PBUF_RING ), static_cast< void * >( &registration ), 1u ),
+            ThrowErrorFromErrno() );
+
+    bufferGroups.push_back( std::move( group ) );
+
+    for ( std::uint16_t id = 0; id < count; ++id )
+        Recycle( bufferGroups.back(), id );
+
+    return buffer_group_t( groupID );
+   }
+
+void Po7::ring::Recycle( buffer_group& group, std::uint16_t bufferID )
+   {
+    // Don't use io_uring_buf_ring::bufs: compiled as C++, its flexible array member doesn't start at offset zero.
+    // The ring is just an array of io_uring_buf, with the tail in the first entry's resv field.
+    io_uring_buf *entries = static_cast< io_uring_buf * >( group.entries.get() );
+    io_uring_buf& entry   = entries[ group.tail & group.mask ];
+
+    entry.addr = reinterpret_cast< std::uintptr_t >( group.storage.get() + bufferID * group.bufferSize );
+    entry.len  = static_cast< std::uint32_t >( group.bufferSize );
+    entry.bid  = bufferID;
+
+    StoreRelease( &entries[ 0 ].resv, ++group.tail );
+   }
+
+// An interrupted wait has submitted nothing (the kernel reports a count instead, if it got that far),
+// so it's returned as zero, like a wait that found nothing, rather than thrown.
+std::size_t Po7::ring::Enter( unsigned minimumCompletions )
+   {
+    std::size_t submitted = Invoke( int_InterruptibleCountResult(),
+                                    SystemIoUringEnter,
+                                    In( *descriptor, unsubmitted, minimumCompletions, minimumCompletions != 0 ? unsigned( IORING_ENTER_GETEVENTS ) : 0u ),
+                                    ThrowErrorFromErrno() );
+
+    unsubmitted -= static_cast< unsigned >( submitted );
+    return submitted;
+   }
+
+std::size_t Po7::ring::submit()
+   {
+    if ( unsubmitted == 0 )
+        return 0;
+
+    return Enter( 0 );
+   }
+
+std::size_t Po7::ring::run_once()
+   {
+    if ( inFlight != 0 && LoadAcquire( completionTail ) == *completionHead )
+        Enter( 1 );
+    else
+        submit();
+
+    return reap();
+   }
+
+std::size_t Po7::ring::reap()
+   {
+    std::size_t called = 0;
+
+    for (;;)
+       {
+        unsigned head = *completionHead;
+        if ( head == LoadAcquire( completionTail ) )
+            return called;
+
+        const io_uring_cqe& completion = completionEntryArray[ head & completionMask ];
+        std::uint64_t userData = completion.user_data;
+        int           result   = completion.res;
+        std::uint32_t flags    = completion.flags;
+
+        // Free the entry before calling the handler, which may queue more requests or throw.
+        StoreRelease( completionHead, head + 1 );
+
+        Complete( userData, result, flags );
+        ++called;
+       }
+   }
+
+void Po7::ring::Complete( std::uint64_t userData, int result, std::uint32_t flags )
+   {
+    std::uint32_t index = static_cast< std::uint32_t >( userData );
+    operation finished  = std::move( operations[ index ] );
+    operations[ index ] = operation();
+    freeOperations.push_back( index );
+    --inFlight;
+
+    std::error_code error;
+
+    switch ( finished.kind )
+       {
+        case operation_kind::accept:
+           {
+            unique_socket accepted;
+            InterpretCompletion( Result< unique_socket >() + FailsWhenFalse(), result, accepted, error );
+
+            if ( finished.onAccept )
+                finished.onAccept( std::move( accepted ), error );
+           }
+            break;
+
+        case operation_kind::transfer:
+           {
+            std::size_t transferred = 0;
+            InterpretCompletion( int_CountResult(), result, transferred, error );
+
+            if ( finished.onTransfer )
+                finished.onTransfer( transferred, error );
+           }
+            break;
+
+        case operation_kind::buffer:
+           {
+            std::size_t transferred = 0;
+            InterpretCompletion( int_CountResult(), result, transferred, error );
+
+            buffer_group& group = bufferGroups[ finished.group ];
+            const char *data    = nullptr;
+            bool hasBuffer      = ( flags & IORING_CQE_F_BUFFER ) != 0;
+            std::uint16_t id    = static_cast< std::uint16_t >( flags >> IORING_CQE_BUFFER_SHIFT );
+
+            if ( hasBuffer )
+                data = group.storage.get() + id * group.bufferSize;
+
+            try
+               {
+                if ( finished.onBuffer )
+                    finished.onBuffer( data, transferred, error );
+               }
+            catch ( ... )
+               {
+                if ( hasBuffer )
+                    Recycle( group, id );
+                throw;
+               }
+
+            if ( hasBuffer )
+                Recycle( group, id );
+           }
+            break;
+
+        case operation_kind::close:
+           {
+            InterpretCompletion( FailureFlagResult<int>(), result, error );
+
+            if ( finished.onClose )
+                finished.onClose( error );
+           }
+            break;
+       }
+   }
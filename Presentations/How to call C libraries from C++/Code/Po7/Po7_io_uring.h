@@ -0,0 +1,208 @@
+//
+//  Po7_io_uring.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_IO_URING_H
+#define PO7_IO_URING_H
+
+#include "Po7_socket.h"
+#include "Po7_unistd.h"
+
+#include "bufferlike.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <system_error>
+#include <vector>
+
+#include <linux/io_uring.h>
+
+namespace Po7
+   {
+    // io_uring isn't POSIX; it's Linux's completion-based interface.  Requests are queued in memory shared with
+    // the kernel and submitted many at a time; results come back the same way.  There's no library to wrap --
+    // only three system calls -- so ring talks to the kernel directly.
+
+    // fixed_file_t is an index into the table of descriptors registered with a ring.
+        struct FixedFileTag
+           {
+            constexpr unsigned operator()() const           { return 0; }
+            static const bool hasEquality                   = true;
+            static const bool hasComparison                 = true;
+           };
+
+        using fixed_file_t = PlusPlus::Boxed< FixedFileTag >;
+
+    // buffer_group_t identifies a ring of buffers provided to the kernel, from which it picks one for each receive.
+        struct BufferGroupTag
+           {
+            constexpr std::uint16_t operator()() const      { return 0; }
+            static const bool hasEquality                   = true;
+           };
+
+        using buffer_group_t = PlusPlus::Boxed< BufferGroupTag >;
+
+
+    // ring queues accept, recv, send and close requests, submits them in batches, and calls a handler for each
+    // when it completes.  A result is interpreted by the same result group as the corresponding Po7 call, so
+    // a handler receives what that call would return, or the std::error_code it would throw.
+    //
+    // Queuing a request makes no system call.  submit hands everything queued to the kernel in one call;
+    // run_once does that and also waits for completions, then calls their handlers.  Buffers passed to recv
+    // and send must last until the handler is called.
+    //
+    // Handlers may queue more requests.  A handler that throws leaves the remaining completions for the
+    // next reap.
+        class ring
+           {
+            public:
+                using accept_handler   = std::function< void ( unique_socket, std::error_code ) >;
+                using transfer_handler = std::function< void ( std::size_t, std::error_code ) >;
+                using buffer_handler   = std::function< void ( const char *, std::size_t, std::error_code ) >;
+                using close_handler    = std::function< void ( std::error_code ) >;
+
+            private:
+                struct MappingDeleter
+                   {
+                    std::size_t length;
+                    void operator()( void * ) const;
+                   };
+
+                using mapping = std::unique_ptr< void, MappingDeleter >;
+
+                enum class operation_kind: unsigned char { accept, transfer, buffer, close };
+
+                struct operation
+                   {
+                    operation_kind    kind = operation_kind::transfer;
+                    std::uint16_t     group = 0;
+                    accept_handler    onAccept;
+                    transfer_handler  onTransfer;
+                    buffer_handler    onBuffer;
+                    close_handler     onClose;
+                   };
+
+                struct buffer_group
+                   {
+                    mapping                    entries;        // the io_uring_buf_ring shared with the kernel
+                    std::unique_ptr< char[] >  storage;
+                    std::size_t                bufferSize;
+                    std::uint16_t              mask;
+                    std::uint16_t              tail;
+                   };
+
+                mapping       rings;
+                mapping       submissions;
+
+                unsigned      *submissionHead;
+                unsigned      *submissionTail;
+                unsigned      submissionMask;
+                unsigned      submissionEntries;
+                io_uring_sqe  *submissionEntryArray;
+
+                unsigned      *completionHead;
+                unsigned      *completionTail;
+                unsigned      completionMask;
+                io_uring_cqe  *completionEntryArray;
+
+                unsigned      queuedTail  = 0;
+                unsigned      unsubmitted = 0;
+
+                std::vector< operation >       operations;
+                std::vector< std::uint32_t >   freeOperations;
+                std::size_t                    inFlight = 0;
+                std::vector< buffer_group >    bufferGroups;
+
+                // Declared last so that it's destroyed first: closing the ring ends the kernel's use of
+                // the buffers above before they're freed.
+                unique_fd     descriptor;
+
+                std::uint32_t NewOperation( operation_kind );
+                io_uring_sqe& Prepare( std::uint8_t opcode, int fd, bool fixed );
+                void Recycle( buffer_group&, std::uint16_t bufferID );
+                void Complete( std::uint64_t userData, int result, std::uint32_t flags );
+                std::size_t Enter( unsigned minimumCompletions );
+
+                void QueueAccept( int fd, bool fixed, socket_flags_t, accept_handler );
+                void QueueRecv( int fd, bool fixed, void *buffer, std::size_t length, msg_flags_t, transfer_handler );
+                void QueueRecv( int fd, bool fixed, buffer_group_t, msg_flags_t, buffer_handler );
+                void QueueSend( int fd, bool fixed, const void *buffer, std::size_t length, msg_flags_t, transfer_handler );
+
+            public:
+            // The ring holds at least this many queued requests; it's created with IORING_SETUP_CLAMP.
+                explicit ring( unsigned entries = 256 );
+
+                ring( const ring& )             = delete;
+                ring& operator=( const ring& )  = delete;
+
+            // accept, recv and send are queued for a socket or for a registered descriptor.
+                void accept( socket_t s,     accept_handler h, socket_flags_t f = socket_flags_t() )                { QueueAccept( Unwrap( s ), false, f, std::move( h ) ); }
+                void accept( fixed_file_t s, accept_handler h, socket_flags_t f = socket_flags_t() )                { QueueAccept( int( Unwrap( s ) ), true, f, std::move( h ) ); }
+
+                void recv( socket_t s,     void *buffer, std::size_t length, transfer_handler h, msg_flags_t f = msg_flags_t() )
+                   { QueueRecv( Unwrap( s ), false, buffer, length, f, std::move( h ) ); }
+                void recv( fixed_file_t s, void *buffer, std::size_t length, transfer_handler h, msg_flags_t f = msg_flags_t() )
+                   { QueueRecv( int( Unwrap( s ) ), true, buffer, length, f, std::move( h ) ); }
+
+                void send( socket_t s,     const void *buffer, std::size_t length, transfer_handler h, msg_flags_t f = msg_flags_t() )
+                   { QueueSend( Unwrap( s ), false, buffer, length, f, std::move( h ) ); }
+                void send( fixed_file_t s, const void *buffer, std::size_t length, transfer_handler h, msg_flags_t f = msg_flags_t() )
+                   { QueueSend( int( Unwrap( s ) ), true, buffer, length, f, std::move( h ) ); }
+
+                template < class Socket, class Buffer >
+                auto recv( Socket s, Buffer& b, transfer_handler h, msg_flags_t f = msg_flags_t() )
+                -> typename std::enable_if< PlusPlus::stdish::is_bufferlike<Buffer>::value >::type
+                   {
+                    recv( s, PlusPlus::stdish::bufferlike_data( b ), PlusPlus::stdish::bufferlike_size( b ), std::move( h ), f );
+                   }
+
+                template < class Socket, class Buffer >
+                auto send( Socket s, const Buffer& b, transfer_handler h, msg_flags_t f = msg_flags_t() )
+                -> typename std::enable_if< PlusPlus::stdish::is_bufferlike<Buffer>::value >::type
+                   {
+                    send( s, PlusPlus::stdish::bufferlike_data( b ), PlusPlus::stdish::bufferlike_size( b ), std::move( h ), f );
+                   }
+
+            // This form of recv lets the kernel pick a buffer from a group when data arrives, so idle connections
+            // don't tie up buffers.  The handler sees the data in place; the buffer goes back to the group after
+            // the handler returns.
+                void recv( socket_t s,     buffer_group_t g, buffer_handler h, msg_flags_t f = msg_flags_t() )      { QueueRecv( Unwrap( s ), false, g, f, std::move( h ) ); }
+                void recv( fixed_file_t s, buffer_group_t g, buffer_handler h, msg_flags_t f = msg_flags_t() )      { QueueRecv( int( Unwrap( s ) ), true, g, f, std::move( h ) ); }
+
+            // close takes over the obligation to close the socket.
+                void close( unique_socket, close_handler = close_handler() );
+
+                template < socket_domain_t domain >
+                void close( unique_socket_in_domain<domain> s, close_handler h = close_handler() )
+                   {
+                    close( unique_socket( std::move( s ) ), std::move( h ) );
+                   }
+
+            // register_files makes a table of count empty slots for registered descriptors; register_file fills a slot.
+            // Requests on a registered descriptor skip the kernel's descriptor lookup.  The slot doesn't own the
+            // descriptor; unregister it (with a null fd_t) before closing it.
+                void register_files( unsigned count );
+                void register_file( fixed_file_t, fd_t );
+
+            // provide_buffers gives the kernel a group of count buffers of size bytes each; count must be a power of two.
+                buffer_group_t provide_buffers( std::uint16_t count, std::size_t size );
+
+            // submit hands the queued requests to the kernel, and returns how many it took.
+                std::size_t submit();
+
+            // reap calls the handlers of completed requests without waiting, and returns how many it called.
+                std::size_t reap();
+
+            // run_once submits, waits for at least one completion if any requests are in flight, and reaps.
+                std::size_t run_once();
+
+            // pending is the number of requests queued or in flight.
+                std::size_t pending() const                 { return inFlight; }
+           };
+   }
+
+#endif
@@ -62,6 +62,21 @@ namespace Po7
         
     // And sockaddr_domain maps sockaddr types to domains.  It's an integral_constant of type socket_domain_t.
         template < class addr_type > struct sockaddr_domain;
+
+    // sockaddr_length is the length to pass along with an address.  It's the size of the address type,
+    // except for types like sockaddr_un, whose length depends on the contents.  Such types specialize
+    // sockaddr_length_trait.
+        template < class addr_type >
+        struct sockaddr_length_trait
+           {
+            static socklen_t length( const addr_type& )     { return sizeof( addr_type ); }
+           };
+
+        template < class addr_type >
+        socklen_t sockaddr_length( const addr_type& a )
+           {
+            return sockaddr_length_trait< addr_type >::length( a );
+           }
    }
 
 #endif
@@ -0,0 +1,106 @@
+//
+//  Po7_mman.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_mman.h"
+#include "Po7_Invoke.h"
+
+#include <limits>
+#include <stdexcept>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+void Po7::MappingDeleter::operator()( pointer p ) const
+   {
+    // Don't use Invoke in the deleter; this must ignore errors
+
+    if ( p->data() != nullptr )
+        ::munmap( p->data(), p->size() );
+   }
+
+namespace
+   {
+    struct MappingResult
+       {
+        std::size_t length;
+
+        using ResultType                                                    = void *;
+        bool CheckForFailure( void *p ) const                               { return p == MAP_FAILED; }
+        std::tuple<> ThrownParts( void * ) const                            { return std::tuple<>(); }
+        std::tuple< Po7::unique_mapping > ReturnedParts( void *p ) const    { return std::make_tuple( Po7::Seize< Po7::unique_mapping >( Po7::mapping( p, length ) ) ); }
+       };
+
+    std::size_t PageSize()
+       {
+        static const std::size_t size = static_cast< std::size_t >( ::sysconf( _SC_PAGESIZE ) );
+        return size;
+       }
+   }
+
+auto Po7::mmap( std::size_t length, prot_t prot, map_flags_t flags, fd_t file, ::off_t offset ) -> unique_mapping
+   {
+    return Invoke( MappingResult{ length },
+                   ::mmap,
+                   In( nullptr, length, prot, flags, file, offset ),
+                   ThrowErrorFromErrno() );
+   }
+
+auto Po7::mmap( fd_t file, prot_t prot, map_flags_t flags ) -> unique_mapping
+   {
+    struct ::stat status;
+
+    Invoke( FailureFlagResult<int>(),
+            ::fstat,
+            In( file ),
+            InOut( status ),
+            ThrowErrorFromErrno() );
+
+    if ( status.st_size == 0 )
+        return unique_mapping();
+
+    if ( static_cast< std::uintmax_t >( status.st_size ) > std::numeric_limits< std::size_t >::max() )
+        throw std::length_error( "File too large to map" );
+
+    return mmap( static_cast< std::size_t >( status.st_size ), prot, flags, file );
+   }
+
+auto Po7::mmap( std::size_t length, prot_t prot, map_flags_t flags ) -> unique_mapping
+   {
+    return mmap( length, prot, flags | map_anonymous, fd_t(), 0 );
+   }
+
+void Po7::munmap( unique_mapping m )
+   {
+    if ( !m )
+        return;
+
+    const mapping released = Release( std::move( m ) );
+
+    return Invoke( FailureFlagResult<int>(),
+                   ::munmap,
+                   In( released.data(), released.size() ),
+                   ThrowErrorFromErrno() );
+   }
+
+void Po7::madvise( const mapping& m, advice_t advice )
+   {
+    madvise( m, 0, m.size(), advice );
+   }
+
+void Po7::madvise( const mapping& m, std::size_t offset, std::size_t length, advice_t advice )
+   {
+    if ( offset > m.size() || length > m.size() - offset )
+        throw std::out_of_range( "madvise range is outside the mapping" );
+
+    // The mapping itself starts on a page boundary, so widening down stays inside it.
+    std::size_t slack = offset % PageSize();
+
+    return Invoke( FailureFlagResult<int>(),
+                   ::madvise,
+                   In( static_cast< void * >( m.data() + offset - slack ), length + slack, advice ),
+                   ThrowErrorFromErrno() );
+   }
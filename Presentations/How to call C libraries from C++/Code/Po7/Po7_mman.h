@@ -0,0 +1,169 @@
+//
+//  Po7_mman.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_MMAN_H
+#define PO7_MMAN_H
+
+#include "Po7_Basics.h"
+#include "Po7_unistd.h"
+
+#include "arraylike.h"
+
+#include <cstddef>
+#include <memory>
+
+#include <sys/types.h>
+#include <sys/mman.h>
+
+namespace Po7
+   {
+    // mapping represents a range of memory mapped by mmap: its address and its length.  Like a pointer, it
+    // doesn't own the memory, and being const doesn't make the memory const.
+    //
+    // A mapping is arraylike, with char elements, and therefore bufferlike: a mapped file can be passed
+    // directly to send, or to anything else that takes a buffer, with no read() into a buffer of its own.
+        class mapping
+           {
+            private:
+                char        *address;
+                std::size_t  length;
+
+            public:
+                mapping()                                       : address( nullptr ), length( 0 ) {}
+                mapping( void *a, std::size_t n )               : address( static_cast< char * >( a ) ), length( n ) {}
+
+                char *data() const                              { return address; }
+                std::size_t size() const                        { return length; }
+
+                char *begin() const                             { return address; }
+                char *end() const                               { return address + length; }
+
+                friend bool operator==( const mapping& a, const mapping& b )    { return a.address == b.address && a.length == b.length; }
+                friend bool operator!=( const mapping& a, const mapping& b )    { return !( a == b ); }
+           };
+
+        inline char       *arraylike_data(       mapping& m )           { return m.data(); }
+        inline char const *arraylike_data( const mapping& m )           { return m.data(); }
+        inline std::size_t arraylike_size( const mapping& m )           { return m.size(); }
+
+    // unique_mapping refers to a mapping, and represents the obligation to unmap it
+        struct MappingDeleter
+           {
+            using pointer = PlusPlus::PointerToValue< mapping >;
+            void operator()( pointer m ) const;
+           };
+
+        using unique_mapping = std::unique_ptr< const mapping, MappingDeleter >;
+   }
+
+namespace std
+   {
+    // As for the Boxed handles (see UniquePtrToValue.h), *m must refer to the mapping the unique_ptr holds,
+    // not to a copy that's gone by the time send reads it.
+    template < class D >
+    class unique_ptr< const Po7::mapping, D >: public PlusPlus::UniquePtrToValue< const Po7::mapping, D >
+       {
+        public:
+            using PlusPlus::UniquePtrToValue< const Po7::mapping, D >::UniquePtrToValue;
+            using PlusPlus::UniquePtrToValue< const Po7::mapping, D >::operator=;
+
+            unique_ptr() noexcept = default;
+       };
+   }
+
+namespace Po7
+   {
+    // prot_t is the third parameter to mmap()
+        struct ProtTag
+           {
+            constexpr int operator()() const                { return 0; }
+            static const bool hasEquality                   = true;
+            static const bool hasBitwise                    = true;
+           };
+
+        using prot_t = PlusPlus::Boxed< ProtTag >;
+
+        const prot_t prot_none  = prot_t( PROT_NONE );
+        const prot_t prot_read  = prot_t( PROT_READ );
+        const prot_t prot_write = prot_t( PROT_WRITE );
+        const prot_t prot_exec  = prot_t( PROT_EXEC );
+
+    // map_flags_t is the fourth parameter to mmap().  map_populate reads the whole mapping in (or faults it
+    // in, for anonymous memory) before mmap returns, so a scan doesn't stop to fault page by page.
+        struct MapFlagsTag
+           {
+            constexpr int operator()() const                { return 0; }
+            static const bool hasEquality                   = true;
+            static const bool hasBitwise                    = true;
+           };
+
+        using map_flags_t = PlusPlus::Boxed< MapFlagsTag >;
+
+        const map_flags_t map_shared    = map_flags_t( MAP_SHARED );
+        const map_flags_t map_private   = map_flags_t( MAP_PRIVATE );
+        const map_flags_t map_anonymous = map_flags_t( MAP_ANONYMOUS );
+        const map_flags_t map_fixed     = map_flags_t( MAP_FIXED );
+        #ifdef MAP_NORESERVE
+            const map_flags_t map_noreserve = map_flags_t( MAP_NORESERVE );
+        #endif
+        #ifdef MAP_POPULATE
+            const map_flags_t map_populate  = map_flags_t( MAP_POPULATE );
+        #endif
+        #ifdef MAP_HUGETLB
+            const map_flags_t map_hugetlb   = map_flags_t( MAP_HUGETLB );
+        #endif
+
+    // mmap() creates mappings, and munmap() gets rid of them.  The offset must be a multiple of the page size.
+        unique_mapping mmap( std::size_t length, prot_t, map_flags_t, fd_t, ::off_t offset = 0 );
+
+    // This form maps all of a file, as long as it is when mmap is called.  An empty file gives a null mapping.
+        unique_mapping mmap( fd_t, prot_t = prot_read, map_flags_t = map_private );
+
+    // This form maps anonymous memory, for buffers too large to be comfortable on the heap.
+        unique_mapping mmap( std::size_t length, prot_t = prot_read | prot_write, map_flags_t = map_private );
+
+    // Calling munmap allows any final errors to be thrown.
+        void munmap( unique_mapping );
+
+
+    // advice_t is the third parameter to madvise().  madv_sequential makes the kernel read ahead aggressively
+    // and drop pages behind; madv_willneed starts reading a range now.  madv_hugepage asks for transparent
+    // huge pages, which cut TLB misses on large scans; whether the kernel can supply them for a file depends
+    // on the filesystem.  madv_populate_read (Linux 5.14) faults a range in, like map_populate after the fact.
+        enum class advice_t: int {};
+        template <> struct Wrapper< advice_t >: PlusPlus::EnumWrapper< advice_t > {};
+
+        const advice_t madv_normal     = advice_t( MADV_NORMAL );
+        const advice_t madv_random     = advice_t( MADV_RANDOM );
+        const advice_t madv_sequential = advice_t( MADV_SEQUENTIAL );
+        const advice_t madv_willneed   = advice_t( MADV_WILLNEED );
+        const advice_t madv_dontneed   = advice_t( MADV_DONTNEED );
+        #ifdef MADV_HUGEPAGE
+            const advice_t madv_hugepage   = advice_t( MADV_HUGEPAGE );
+            const advice_t madv_nohugepage = advice_t( MADV_NOHUGEPAGE );
+        #endif
+        #ifdef MADV_POPULATE_READ
+            const advice_t madv_populate_read  = advice_t( MADV_POPULATE_READ );
+            const advice_t madv_populate_write = advice_t( MADV_POPULATE_WRITE );
+        #endif
+
+    // madvise advises about a whole mapping, or about length bytes starting at offset within it.
+    // The range is widened to whole pages.
+        void madvise( const mapping&, advice_t );
+        void madvise( const mapping&, std::size_t offset, std::size_t length, advice_t );
+   }
+
+namespace PlusPlus
+   {
+    namespace stdish
+       {
+        template <> struct is_arraylike< Po7::mapping >:            std::true_type {};
+        template <> struct arraylike_element_type< Po7::mapping >   { using type = char; };
+       }
+   }
+
+#endif
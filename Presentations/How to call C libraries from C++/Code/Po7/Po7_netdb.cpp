@@ -0,0 +1,81 @@
+//
+//  Po7_netdb.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_netdb.h"
+#include "Po7_Invoke.h"
+
+#include <cerrno>
+#include <cstring>
+
+namespace
+   {
+    class GaiCategory: public std::error_category
+       {
+        public:
+            const char *name() const noexcept override          { return "getaddrinfo"; }
+            std::string message( int code ) const override      { return ::gai_strerror( code ); }
+       };
+   }
+
+const std::error_category& Po7::gai_category()
+   {
+    static const GaiCategory category;
+    return category;
+   }
+
+std::error_code Po7::gai_error_code( int gaiError )
+   {
+    if ( gaiError == 0 )
+        return std::error_code();
+
+    if ( gaiError == EAI_SYSTEM )
+        return Wrap< std::error_code >( errno );
+
+    return std::error_code( gaiError, gai_category() );
+   }
+
+auto Po7::MakeAnything( ThingToMake< addrinfo >, socket_domain_t domain, socket_type_t type, addrinfo_flags_t flags ) -> addrinfo
+   {
+    addrinfo result;
+    std::memset( &result, 0, sizeof( result ) );
+
+    result.ai_family   = Unwrap( domain );
+    result.ai_socktype = Unwrap( type );
+    result.ai_flags    = Unwrap( flags );
+
+    return result;
+   }
+
+void Po7::AddrinfoDeleter::operator()( addrinfo *list ) const
+   {
+    if ( list != nullptr )
+        ::freeaddrinfo( list );
+   }
+
+auto Po7::getaddrinfo( const char *node, const char *service, const addrinfo& hints, std::error_code& error ) -> unique_addrinfo
+   {
+    addrinfo *list = nullptr;
+
+    int result = Invoke( Result< int >(),
+                         ::getaddrinfo,
+                         In( node, service, &hints ),
+                         InOut( list ) );
+
+    error = gai_error_code( result );
+    return Seize< unique_addrinfo >( list );
+   }
+
+auto Po7::getaddrinfo( const char *node, const char *service, const addrinfo& hints ) -> unique_addrinfo
+   {
+    std::error_code error;
+    unique_addrinfo list = getaddrinfo( node, service, hints, error );
+
+    if ( error )
+        throw std::system_error( error );
+
+    return list;
+   }
@@ -0,0 +1,70 @@
+//
+//  Po7_netdb.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_NETDB_H
+#define PO7_NETDB_H
+
+#include "Po7_Basics.h"
+#include "Po7_is_sockaddr.h"
+#include "Po7_socket.h"
+
+#include <memory>
+#include <string>
+#include <system_error>
+
+#include <netdb.h>
+
+namespace Po7
+   {
+    // getaddrinfo reports its own error codes, not errno values.  gai_category gives them names and messages;
+    // gai_error_code makes an error_code from one, reporting EAI_SYSTEM as the errno value it stands for.
+        const std::error_category& gai_category();
+
+        std::error_code gai_error_code( int gaiError );
+
+    // addrinfo_flags_t is the ai_flags member of the hints to getaddrinfo()
+        struct AddrinfoFlagsTag
+           {
+            constexpr int operator()() const                { return 0; }
+            static const bool hasEquality                   = true;
+            static const bool hasBitwise                    = true;
+           };
+
+        using addrinfo_flags_t = PlusPlus::Boxed< AddrinfoFlagsTag >;
+
+        const addrinfo_flags_t ai_passive     = addrinfo_flags_t( AI_PASSIVE );
+        const addrinfo_flags_t ai_canonname   = addrinfo_flags_t( AI_CANONNAME );
+        const addrinfo_flags_t ai_numerichost = addrinfo_flags_t( AI_NUMERICHOST );
+        const addrinfo_flags_t ai_numericserv = addrinfo_flags_t( AI_NUMERICSERV );
+        const addrinfo_flags_t ai_v4mapped    = addrinfo_flags_t( AI_V4MAPPED );
+        const addrinfo_flags_t ai_all         = addrinfo_flags_t( AI_ALL );
+        const addrinfo_flags_t ai_addrconfig  = addrinfo_flags_t( AI_ADDRCONFIG );
+
+        using ::addrinfo;
+
+        addrinfo MakeAnything( ThingToMake< addrinfo >, socket_domain_t, socket_type_t, addrinfo_flags_t = addrinfo_flags_t() );
+
+    // unique_addrinfo owns a list of results from getaddrinfo, and frees it with freeaddrinfo
+        struct AddrinfoDeleter
+           {
+            void operator()( addrinfo * ) const;
+           };
+
+        using unique_addrinfo = std::unique_ptr< addrinfo, AddrinfoDeleter >;
+
+    // getaddrinfo blocks while it consults /etc/hosts, DNS, and whatever else the system is configured to use.
+    // Either node or service may be null, but not both.
+        unique_addrinfo getaddrinfo( const char *node, const char *service, const addrinfo& hints );
+        unique_addrinfo getaddrinfo( const char *node, const char *service, const addrinfo& hints, std::error_code& );
+
+        inline unique_addrinfo getaddrinfo( const std::string& node, const addrinfo& hints )
+           {
+            return getaddrinfo( node.c_str(), nullptr, hints );
+           }
+   }
+
+#endif
@@ -0,0 +1,269 @@
+//
+//  Po7_resolver.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_resolver.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace
+   {
+    std::string CacheKey( const std::string& host, Po7::socket_domain_t domain )
+       {
+        std::string key( 1, char( Po7::Unwrap( domain ) ) );
+        return key += host;
+       }
+
+    // Numeric addresses are answered without a lookup.
+    bool ParseNumeric( const std::string& host, Po7::socket_domain_t domain, std::vector< sockaddr_storage >& addresses )
+       {
+        const char *begin = host.data();
+        const char *end   = begin + host.size();
+
+        sockaddr_storage storage;
+        std::memset( &storage, 0, sizeof( storage ) );
+
+        if ( domain == Po7::af_inet )
+           {
+            Po7::in_addr_t address;
+            if ( Po7::parse( begin, end, address ) != end )
+                return false;
+
+            Po7::sockaddr_cast< sockaddr_in& >( storage ) = Po7::Make< sockaddr_in >( address, Po7::in_port_t() );
+           }
+        else
+           {
+            in6_addr address;
+            if ( Po7::parse( begin, end, address ) != end )
+                return false;
+
+            Po7::sockaddr_cast< sockaddr_in6& >( storage ) = Po7::Make< sockaddr_in6 >( address, Po7::in_port_t() );
+           }
+
+        addresses.assign( 1, storage );
+        return true;
+       }
+
+    // Only a definite answer is cached.  Anything else might go away on the next try.
+    bool IsTemporary( std::error_code error )
+       {
+        if ( error.category() != Po7::gai_category() )
+            return true;
+
+        return error.value() == EAI_AGAIN || error.value() == EAI_MEMORY;
+       }
+   }
+
+auto Po7::resolver::lookup_getaddrinfo( const std::string& host, socket_domain_t domain, std::vector< sockaddr_storage >& addresses ) -> std::error_code
+   {
+    std::error_code error;
+    unique_addrinfo list = getaddrinfo( host.c_str(), nullptr, Make< addrinfo >( domain, sock_stream ), error );
+
+    addresses.clear();
+
+    for ( const addrinfo *a = list.get(); a != nullptr; a = a->ai_next )
+       {
+        if ( a->ai_family != Unwrap( domain ) || a->ai_addrlen > sizeof( sockaddr_storage ) )
+            continue;
+
+        sockaddr_storage storage;
+        std::memset( &storage, 0, sizeof( storage ) );
+        std::memcpy( &storage, a->ai_addr, a->ai_addrlen );
+
+        addresses.push_back( storage );
+       }
+
+    if ( !error && addresses.empty() )
+        error = gai_error_code( EAI_NONAME );
+
+    return error;
+   }
+
+Po7::resolver::resolver( std::size_t threads, clock::duration ttl, clock::duration negativeTtl, lookup_function f, std::size_t entries )
+   : lookup( std::move( f ) ),
+     positiveTTL( ttl ),
+     negativeTTL( negativeTtl ),
+     maxEntries( std::max< std::size_t >( entries, 1 ) ),
+     nextSweep( clock::now() + std::max< clock::duration >( ttl, std::chrono::seconds( 1 ) ) )
+   {
+    try
+       {
+        for ( std::size_t i = 0; i < std::max< std::size_t >( threads, 1 ); ++i )
+            workers.emplace_back( [this]{ Work(); } );
+       }
+    catch ( ... )
+       {
+           {
+            std::lock_guard< std::mutex > lock( mutex );
+            stopping = true;
+           }
+
+        requested.notify_all();
+
+        for ( std::thread& worker : workers )
+            worker.join();
+
+        throw;
+       }
+   }
+
+Po7::resolver::~resolver()
+   {
+    std::vector< raw_handler > canceled;
+
+       {
+        std::lock_guard< std::mutex > lock( mutex );
+        stopping = true;
+
+        for ( const std::string& key : queue )
+           {
+            entry& e = cache[ key ];
+            std::move( e.waiting.begin(), e.waiting.end(), std::back_inserter( canceled ) );
+            e.waiting.clear();
+           }
+
+        queue.clear();
+       }
+
+    requested.notify_all();
+
+    for ( std::thread& worker : workers )
+        if ( worker.joinable() )
+            worker.join();
+
+    const std::vector< sockaddr_storage > none;
+
+    for ( raw_handler& h : canceled )
+        h( none, std::make_error_code( std::errc::operation_canceled ) );
+   }
+
+void Po7::resolver::Resolve( const std::string& host, socket_domain_t domain, raw_handler done )
+   {
+    std::vector< sockaddr_storage > addresses;
+
+    if ( ParseNumeric( host, domain, addresses ) )
+        return done( addresses, std::error_code() );
+
+    const std::string key = CacheKey( host, domain );
+    std::error_code error;
+
+       {
+        std::lock_guard< std::mutex > lock( mutex );
+        const clock::time_point now = clock::now();
+
+        if ( now >= nextSweep || ( cache.size() >= maxEntries && cache.count( key ) == 0 ) )
+            Sweep( now );
+
+        entry& e = cache[ key ];
+
+        if ( e.resolving )
+           {
+            e.waiting.push_back( std::move( done ) );
+            return;
+           }
+
+        if ( e.expires <= now )
+           {
+            e.resolving = true;
+            e.waiting.push_back( std::move( done ) );
+            queue.push_back( key );
+            requested.notify_one();
+            return;
+           }
+
+        addresses = e.addresses;
+        error     = e.error;
+       }
+
+    done( addresses, error );
+   }
+
+void Po7::resolver::Work()
+   {
+    std::unique_lock< std::mutex > lock( mutex );
+
+    for (;;)
+       {
+        requested.wait( lock, [this]{ return stopping || !queue.empty(); } );
+
+        if ( queue.empty() )
+            return;
+
+        const std::string key = std::move( queue.front() );
+        queue.pop_front();
+
+        lock.unlock();
+
+        const socket_domain_t domain = Wrap< socket_domain_t >( int( key[0] ) );
+        std::vector< sockaddr_storage > addresses;
+        std::error_code error = lookup( key.substr( 1 ), domain, addresses );
+
+        lock.lock();
+
+        entry& e = cache[ key ];
+        const clock::time_point now = clock::now();
+
+        e.resolving = false;
+        e.addresses = addresses;
+        e.error     = error;
+        e.expires   = !error                ? now + positiveTTL
+                    : !IsTemporary( error ) ? now + negativeTTL
+                    :                         now;
+
+        std::vector< raw_handler > waiting;
+        waiting.swap( e.waiting );
+
+        lock.unlock();
+
+        for ( raw_handler& h : waiting )
+            h( addresses, error );
+
+        lock.lock();
+       }
+   }
+
+// Sweep drops the expired answers, then if the cache is still full, the answers that expire soonest.
+// Names being looked up stay, since their waiting handlers live in the entries.
+void Po7::resolver::Sweep( clock::time_point now )
+   {
+    nextSweep = now + std::max< clock::duration >( positiveTTL, std::chrono::seconds( 1 ) );
+
+    for ( auto i = cache.begin(); i != cache.end(); )
+        if ( !i->second.resolving && i->second.expires <= now )
+            i = cache.erase( i );
+        else
+            ++i;
+
+    if ( cache.size() < maxEntries )
+        return;
+
+    std::vector< std::pair< clock::time_point, const std::string * > > answers;
+
+    for ( const auto& i : cache )
+        if ( !i.second.resolving )
+            answers.emplace_back( i.second.expires, &i.first );
+
+    const std::size_t excess = std::min( answers.size(), cache.size() - maxEntries + 1 );
+
+    std::nth_element( answers.begin(), answers.begin() + excess, answers.end() );
+    answers.resize( excess );
+
+    for ( const auto& a : answers )
+        cache.erase( *a.second );
+   }
+
+void Po7::resolver::clear()
+   {
+    std::lock_guard< std::mutex > lock( mutex );
+
+    for ( auto i = cache.begin(); i != cache.end(); )
+        if ( i->second.resolving )
+            ++i;
+        else
+            i = cache.erase( i );
+   }
@@ -0,0 +1,126 @@
+//
+//  Po7_resolver.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_RESOLVER_H
+#define PO7_RESOLVER_H
+
+#include "Po7_in.h"
+#include "Po7_netdb.h"
+#include "Po7_socket.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Po7
+   {
+    // resolver looks up host names on a small pool of threads, so code that connects never blocks on DNS.
+    // Answers are cached for a fixed time, since getaddrinfo doesn't report the records' TTLs.  Names that
+    // don't exist are cached too, for a shorter time; temporary failures aren't cached.  Concurrent requests
+    // for a name that's being looked up wait for the same lookup.  Expired answers are swept out as the cache
+    // is used, and when it holds maxEntries names the answers closest to expiring make room for new ones.
+    //
+    // Handlers are called on a resolver thread, or on the caller's thread when the answer is cached or the
+    // name is a numeric address.  They must not throw.  Destroying the resolver calls the handlers of lookups
+    // that haven't started with std::errc::operation_canceled, and waits for the rest.
+    //
+    // The lookup itself is a function of the host name and domain, getaddrinfo by default.  Substituting
+    // another, such as a table of fixed entries, makes the resolver testable without a network.  It must not
+    // throw either.
+        class resolver
+           {
+            public:
+                using clock = std::chrono::steady_clock;
+
+                using lookup_function = std::function< std::error_code ( const std::string& host,
+                                                                         socket_domain_t,
+                                                                         std::vector< sockaddr_storage >& ) >;
+
+                template < socket_domain_t domain >
+                using handler = std::function< void ( std::vector< sockaddr_type< domain > >, std::error_code ) >;
+
+            private:
+                using raw_handler = std::function< void ( const std::vector< sockaddr_storage >&, std::error_code ) >;
+
+                struct entry
+                   {
+                    std::vector< sockaddr_storage >  addresses;
+                    std::error_code                  error;
+                    clock::time_point                expires;
+                    bool                             resolving = false;
+                    std::vector< raw_handler >       waiting;
+                   };
+
+                lookup_function                           lookup;
+                clock::duration                           positiveTTL;
+                clock::duration                           negativeTTL;
+                std::size_t                               maxEntries;
+
+                std::mutex                                mutex;
+                std::condition_variable                   requested;
+                std::unordered_map< std::string, entry >  cache;        // keyed by domain and host name
+                std::deque< std::string >                 queue;
+                clock::time_point                         nextSweep;
+                bool                                      stopping = false;
+                std::vector< std::thread >                workers;
+
+                void Resolve( const std::string& host, socket_domain_t, raw_handler );
+                void Work();
+                void Sweep( clock::time_point now );
+
+                static void SetPort( sockaddr_in&  a, in_port_t p )     { a.sin_port  = Unwrap( p ); }
+                static void SetPort( sockaddr_in6& a, in_port_t p )     { a.sin6_port = Unwrap( p ); }
+
+            public:
+            // lookup_getaddrinfo is the default lookup: getaddrinfo for stream sockets in the domain.
+                static std::error_code lookup_getaddrinfo( const std::string& host, socket_domain_t, std::vector< sockaddr_storage >& );
+
+                explicit resolver( std::size_t threads        = 2,
+                                   clock::duration ttl         = std::chrono::seconds( 30 ),
+                                   clock::duration negativeTtl = std::chrono::seconds( 5 ),
+                                   lookup_function             = lookup_getaddrinfo,
+                                   std::size_t maxEntries      = 4096 );
+                ~resolver();
+
+                resolver( const resolver& )             = delete;
+                resolver& operator=( const resolver& )  = delete;
+
+            // resolve finds the addresses of host in an internet domain, and gives them to the handler
+            // with the port filled in.
+                template < socket_domain_t domain >
+                void resolve( const std::string& host, in_port_t port, handler< domain > done )
+                   {
+                    static_assert( domain == af_inet || domain == af_inet6, "resolver handles internet domains" );
+
+                    Resolve( host, domain, [port, done]( const std::vector< sockaddr_storage >& found, std::error_code error )
+                       {
+                        std::vector< sockaddr_type< domain > > addresses;
+                        addresses.reserve( found.size() );
+
+                        for ( const sockaddr_storage& a : found )
+                           {
+                            addresses.push_back( sockaddr_cast< const sockaddr_type< domain >& >( a ) );
+                            SetPort( addresses.back(), port );
+                           }
+
+                        done( std::move( addresses ), error );
+                       } );
+                   }
+
+            // clear forgets every cached answer.
+                void clear();
+           };
+   }
+
+#endif
@@ -0,0 +1,40 @@
+//
+//  Po7_sendfile.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_sendfile.h"
+#include "Po7_ResultGroups.h"
+
+std::size_t Po7::sendfile( socket_t socket, fd_t file, ::off_t offset, std::size_t count )
+   {
+    std::size_t sent = 0;
+
+    while ( sent < count )
+       {
+        std::size_t part = Invoke( ssize_t_Result(),
+                                   ::sendfile,
+                                   In( socket, file ),
+                                   InOut( offset ),
+                                   In( count - sent ),
+                                   ThrowErrorFromErrno() );
+        if ( part == 0 )
+            break;
+
+        sent += part;
+       }
+
+    return sent;
+   }
+
+auto Po7::try_sendfile( socket_t socket, fd_t file, ::off_t& offset, std::size_t count ) -> try_result
+   {
+    return Invoke( ssize_t_TryResult(),
+                   ::sendfile,
+                   In( socket, file ),
+                   InOut( offset ),
+                   In( count ),
+                   ThrowErrorFromErrno() );
+   }
@@ -0,0 +1,31 @@
+//
+//  Po7_sendfile.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_SENDFILE_H
+#define PO7_SENDFILE_H
+
+#include "Po7_socket.h"
+#include "Po7_unistd.h"
+
+#include <sys/types.h>
+#include <sys/sendfile.h>
+
+namespace Po7
+   {
+    // sendfile isn't POSIX; on Linux it moves file contents to a socket inside the kernel,
+    // without copying them through user memory.
+
+    // This form sends count bytes of the file, starting at offset, calling sendfile until they're all sent.
+    // It returns the number of bytes sent, which is less than count only if the file ends first.
+    // The file's own offset is not used or changed.
+        std::size_t sendfile( socket_t, fd_t file, ::off_t offset, std::size_t count );
+
+    // try_sendfile makes one call, for non-blocking sockets; it advances offset past what was sent.
+        try_result try_sendfile( socket_t, fd_t file, ::off_t& offset, std::size_t count );
+   }
+
+#endif
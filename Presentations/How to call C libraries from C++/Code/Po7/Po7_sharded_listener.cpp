@@ -0,0 +1,191 @@
+//
+//  Po7_sharded_listener.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_sharded_listener.h"
+#include "Po7_sockopt.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <sched.h>
+#include <pthread.h>
+
+namespace
+   {
+    std::vector< int > AllowedCores()
+       {
+        cpu_set_t allowed;
+        CPU_ZERO( &allowed );
+
+        std::vector< int > cores;
+
+        if ( ::sched_getaffinity( 0, sizeof( allowed ), &allowed ) == 0 )
+            for ( int cpu = 0; cpu < CPU_SETSIZE; ++cpu )
+                if ( CPU_ISSET( cpu, &allowed ) )
+                    cores.push_back( cpu );
+
+        if ( cores.empty() )
+            cores.push_back( -1 );          // unknown; don't pin
+
+        return cores;
+       }
+
+    void PinCurrentThread( int core )
+       {
+        if ( core < 0 )
+            return;
+
+        cpu_set_t only;
+        CPU_ZERO( &only );
+        CPU_SET( core, &only );
+
+        // pthread functions return their error rather than setting errno.
+        if ( int error = ::pthread_setaffinity_np( ::pthread_self(), sizeof( only ), &only ) )
+            throw std::system_error( Po7::Wrap< std::error_code >( error ) );
+       }
+
+    bool IsTransientAcceptError( const std::error_code& e )
+       {
+        return e == std::errc::connection_aborted
+            || e == std::errc::interrupted
+            || e == std::errc::protocol_error;
+       }
+
+    // Running out of descriptors or memory passes as connections close, but accept fails at once until it
+    // does, with the connection still waiting.  Retrying at once would spin, so the shard waits a while.
+    bool IsResourceExhaustion( const std::error_code& e )
+       {
+        return e == std::errc::too_many_files_open
+            || e == std::errc::too_many_files_open_in_system
+            || e == std::errc::no_buffer_space
+            || e == std::errc::not_enough_memory;
+       }
+   }
+
+Po7::sharded_listener::sharded_listener( const sockaddr_in6& address, std::size_t shards, int backlog )
+   : cores( AllowedCores() ),
+     boundAddress( address ),
+     stopping( false ),
+     handlerFailures( 0 )
+   {
+    if ( shards == 0 )
+        shards = cores.size();
+
+    for ( std::size_t i = 0; i < shards; ++i )
+       {
+        auto listener = socket< af_inet6 >( sock_stream | sock_cloexec, socket_protocol_t() );
+        setsockopt< so_reuseport >( *listener, true );
+        bind( *listener, boundAddress );
+        listen( *listener, backlog );
+
+        if ( i == 0 )
+            boundAddress = getsockname( *listener );
+
+        listeners.push_back( std::move( listener ) );
+       }
+   }
+
+Po7::sharded_listener::~sharded_listener()
+   {
+    stop();
+
+    for ( std::thread& t : threads )
+        if ( t.joinable() )
+            t.join();
+   }
+
+void Po7::sharded_listener::start( connection_handler handler )
+   {
+    if ( !threads.empty() || stopping )
+        throw std::logic_error( "A sharded_listener can only be started once" );
+
+    failures.assign( listeners.size(), std::exception_ptr() );
+
+    for ( std::size_t shard = 0; shard < listeners.size(); ++shard )
+        threads.emplace_back( [this, shard, handler]
+                                 {
+                                  try
+                                     {
+                                      PinCurrentThread( cores[ shard % cores.size() ] );
+                                      Accept( shard, handler );
+                                     }
+                                  catch ( ... )
+                                     {
+                                      failures[ shard ] = std::current_exception();
+                                     }
+                                 } );
+   }
+
+void Po7::sharded_listener::Accept( std::size_t shard, const connection_handler& handler )
+   {
+    const std::chrono::milliseconds shortestPause( 1 );
+    const std::chrono::milliseconds longestPause( 100 );
+
+    socket_in_domain< af_inet6 > listener = *listeners[ shard ];
+    std::chrono::milliseconds pause = shortestPause;
+
+    while ( !stopping )
+       {
+        std::tuple< unique_socket_in_domain< af_inet6 >, sockaddr_in6 > accepted;
+
+        try
+           {
+            accepted = accept( listener );
+           }
+        catch ( const std::system_error& error )
+           {
+            if ( stopping )
+                return;
+            if ( IsTransientAcceptError( error.code() ) )
+                continue;
+            if ( !IsResourceExhaustion( error.code() ) )
+                throw;
+
+            std::this_thread::sleep_for( pause );
+            pause = std::min( pause * 2, longestPause );
+            continue;
+           }
+
+        pause = shortestPause;
+
+        // The connection goes with the exception; the shard carries on with the next one.
+        try
+           {
+            handler( shard, std::move( std::get<0>( accepted ) ), std::get<1>( accepted ) );
+           }
+        catch ( ... )
+           {
+            ++handlerFailures;
+           }
+       }
+   }
+
+void Po7::sharded_listener::stop()
+   {
+    if ( stopping.exchange( true ) )
+        return;
+
+    // On Linux, shutting down a listening socket wakes threads blocked in accept.
+    for ( const auto& listener : listeners )
+       {
+        try { shutdown( *listener, shut_rd ); }
+        catch ( const std::system_error& ) {}
+       }
+   }
+
+void Po7::sharded_listener::join()
+   {
+    for ( std::thread& t : threads )
+        if ( t.joinable() )
+            t.join();
+
+    threads.clear();
+
+    for ( const std::exception_ptr& failure : failures )
+        if ( failure )
+            std::rethrow_exception( failure );
+   }
@@ -0,0 +1,77 @@
+//
+//  Po7_sharded_listener.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_SHARDED_LISTENER_H
+#define PO7_SHARDED_LISTENER_H
+
+#include "Po7_socket.h"
+#include "Po7_in.h"
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace Po7
+   {
+    // sharded_listener listens on one address with several sockets, using SO_REUSEPORT, and gives each socket
+    // its own thread pinned to its own core.  The kernel spreads incoming connections across the sockets,
+    // so each thread accepts from its own queue: no lock is shared, and a connection wakes only one thread.
+    //
+    // The handler is called on the accepting thread, once per connection, with the shard number.  It should
+    // hand the connection to work that stays on that thread (an event_loop, say) rather than serve it
+    // to completion, or that shard stops accepting in the meantime.
+        class sharded_listener
+           {
+            public:
+                using connection_handler = std::function< void ( std::size_t shard,
+                                                                 unique_socket_in_domain< af_inet6 >,
+                                                                 const sockaddr_in6& ) >;
+
+            private:
+                std::vector< unique_socket_in_domain< af_inet6 > >  listeners;
+                std::vector< int >                                  cores;
+                std::vector< std::thread >                          threads;
+                std::vector< std::exception_ptr >                   failures;
+                sockaddr_in6                                        boundAddress;
+                std::atomic< bool >                                 stopping;
+                std::atomic< std::size_t >                          handlerFailures;
+
+                void Accept( std::size_t shard, const connection_handler& );
+
+            public:
+            // With zero shards, there's one per core this process may run on.  If the address has port zero,
+            // the first shard picks the port and the rest join it.
+                explicit sharded_listener( const sockaddr_in6& address, std::size_t shards = 0, int backlog = SOMAXCONN );
+                ~sharded_listener();
+
+                sharded_listener( const sharded_listener& )             = delete;
+                sharded_listener& operator=( const sharded_listener& )  = delete;
+
+                std::size_t size() const                                    { return listeners.size(); }
+                const sockaddr_in6& address() const                         { return boundAddress; }
+
+            // The listening socket of a shard, for callers that run their own accept loops.
+                socket_in_domain< af_inet6 > listener( std::size_t shard ) const  { return *listeners.at( shard ); }
+
+            // start runs one pinned accept thread per shard.  A sharded_listener can only be started once.
+            // When the process runs out of descriptors or memory, a shard pauses, for up to 100ms at a time,
+            // until accept succeeds again.  If the handler throws, the connection is dropped, the failure is
+            // counted, and the shard goes on accepting.
+                void start( connection_handler );
+
+                std::size_t handler_failures() const                        { return handlerFailures; }
+
+            // stop makes the threads stop accepting; join waits for them, and rethrows the first exception
+            // that ended one.  The destructor stops and joins, ignoring exceptions.
+                void stop();
+                void join();
+           };
+   }
+
+#endif
@@ -0,0 +1,91 @@
+//
+//  Po7_signalfd.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_signalfd.h"
+#include "Po7_ResultGroups.h"
+
+void Po7::SignalFDDeleter::operator()( pointer p ) const
+   {
+    // Don't use Invoke in the deleter; this must ignore errors
+
+    int descriptor = Unwrap( *p );
+
+    if ( descriptor != -1 )
+        ::close( descriptor );
+   }
+
+auto Po7::MakeAnything( ThingToMake< sigset_t >, std::initializer_list< int > signals ) -> sigset_t
+   {
+    sigset_t result;
+    ::sigemptyset( &result );
+
+    for ( int signal : signals )
+        if ( ::sigaddset( &result, signal ) != 0 )
+            throw MakeSystemErrorFromErrno();
+
+    return result;
+   }
+
+auto Po7::pthread_sigmask( sigmask_how_t how, const sigset_t& mask ) -> sigset_t
+   {
+    sigset_t previous;
+
+    Invoke( int_ErrorNumberResult(),
+            ::pthread_sigmask,
+            In( how, mask ),
+            InOut( previous ) );
+
+    return previous;
+   }
+
+auto Po7::signalfd( const sigset_t& mask, signalfd_flags_t flags ) -> unique_signalfd
+   {
+    return Invoke( Result< unique_signalfd >() + FailsWhenFalse(),
+                   ::signalfd,
+                   In( signalfd_t(), mask, flags ),
+                   ThrowErrorFromErrno() );
+   }
+
+void Po7::signalfd( signalfd_t s, const sigset_t& mask )
+   {
+    return Invoke( int_FlagResult(),
+                   ::signalfd,
+                   In( s, mask, signalfd_flags_t() ),
+                   ThrowErrorFromErrno() );
+   }
+
+void Po7::close( unique_signalfd s )
+   {
+    return Invoke( FailureFlagResult<int>(),
+                   ::close,
+                   In( std::move( s ) ),
+                   ThrowErrorFromErrno() );
+   }
+
+auto Po7::signalfd_read( signalfd_t s ) -> signalfd_siginfo
+   {
+    signalfd_siginfo info;
+
+    Invoke( ssize_t_FlagResult(),
+            ::read,
+            In( s ),
+            InOut( info ),
+            In( sizeof( info ) ),
+            ThrowErrorFromErrno() );
+
+    return info;
+   }
+
+bool Po7::try_signalfd_read( signalfd_t s, signalfd_siginfo& info )
+   {
+    return Invoke( ssize_t_ReadyResult(),
+                   ::read,
+                   In( s ),
+                   InOut( info ),
+                   In( sizeof( info ) ),
+                   ThrowErrorFromErrno() );
+   }
@@ -0,0 +1,100 @@
+//
+//  Po7_signalfd.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_SIGNALFD_H
+#define PO7_SIGNALFD_H
+
+#include "Po7_Basics.h"
+#include "Po7_unistd.h"
+
+#include <initializer_list>
+#include <memory>
+
+#include <signal.h>
+#include <sys/signalfd.h>
+
+namespace Po7
+   {
+    // A signalfd receives signals as data.  It becomes readable when one of its signals is pending, so an
+    // epoll instance can wait for signals along with its sockets, and the handling runs as ordinary code
+    // rather than in a signal handler.  The signals must be blocked in every thread, or they'll be delivered
+    // the usual way instead; pthread_sigmask does that for the calling thread and the threads it starts later.
+
+    // signalfd_t represents a signalfd
+        struct SignalFDTag
+           {
+            constexpr int operator()() const            { return -1; }
+            static const bool hasEquality               = true;
+            static const bool hasComparison             = true;
+            constexpr operator FileDescriptorTag() const { return FileDescriptorTag(); }
+           };
+
+        using signalfd_t = PlusPlus::Boxed< SignalFDTag >;
+
+    // unique_signalfd refers to a signalfd, and represents the obligation to close it
+        struct SignalFDDeleter
+           {
+            using pointer = PlusPlus::PointerToValue< signalfd_t >;
+            void operator()( pointer s ) const;
+            operator FileDescriptorDeleter() const  { return FileDescriptorDeleter(); }
+           };
+
+        using unique_signalfd = std::unique_ptr< const signalfd_t, SignalFDDeleter >;
+
+
+    // sigset_t is made from signal numbers, as in Make< sigset_t >( SIGINT, SIGTERM ).
+        using ::sigset_t;
+
+        sigset_t MakeAnything( ThingToMake< sigset_t >, std::initializer_list< int > signals );
+
+        template < class... More >
+        sigset_t MakeAnything( ThingToMake< sigset_t >, int signal, More... more )
+           {
+            return MakeAnything( ThingToMake< sigset_t >(), { signal, more... } );
+           }
+
+    // sigmask_how_t is the first parameter to pthread_sigmask()
+        enum class sigmask_how_t: int {};
+        template <> struct Wrapper< sigmask_how_t >: PlusPlus::EnumWrapper< sigmask_how_t > {};
+
+        const sigmask_how_t sig_block   = sigmask_how_t( SIG_BLOCK );
+        const sigmask_how_t sig_unblock = sigmask_how_t( SIG_UNBLOCK );
+        const sigmask_how_t sig_setmask = sigmask_how_t( SIG_SETMASK );
+
+    // pthread_sigmask changes the calling thread's signal mask, and returns the mask it replaces.
+        sigset_t pthread_sigmask( sigmask_how_t, const sigset_t& );
+
+
+    // signalfd_flags_t is the third parameter to signalfd()
+        struct SignalFDFlagsTag
+           {
+            constexpr int operator()() const                { return 0; }
+            static const bool hasEquality                   = true;
+            static const bool hasBitwise                    = true;
+           };
+
+        using signalfd_flags_t = PlusPlus::Boxed< SignalFDFlagsTag >;
+
+        const signalfd_flags_t sfd_cloexec  = signalfd_flags_t( SFD_CLOEXEC );
+        const signalfd_flags_t sfd_nonblock = signalfd_flags_t( SFD_NONBLOCK );
+
+    // signalfd() creates signalfds, and close() gets rid of them.  Given an existing signalfd, signalfd()
+    // replaces the set of signals it receives.
+        unique_signalfd signalfd( const sigset_t&, signalfd_flags_t = signalfd_flags_t() );
+        void signalfd( signalfd_t, const sigset_t& );
+
+        void close( unique_signalfd );
+
+    // signalfd_read waits for a signal and returns its description, taking it from the pending set.
+    // try_signalfd_read is for sfd_nonblock signalfds; it returns false if no signal is pending.
+        using ::signalfd_siginfo;
+
+        signalfd_siginfo signalfd_read( signalfd_t );
+        bool try_signalfd_read( signalfd_t, signalfd_siginfo& );
+   }
+
+#endif
@@ -7,7 +7,9 @@
 //
 
 #include "Po7_socket.h"
-#include "Po7_Invoke.h"
+#include "Po7_ResultGroups.h"
+
+#include <cstring>
 
 void Po7::SocketDeleter::operator()( pointer p ) const
    {
@@ -29,6 +31,22 @@ auto Po7::socket( socket_domain_t   domain,
                    ThrowErrorFromErrno() );
    }
 
+auto Po7::socketpair( socket_domain_t   domain,
+                      socket_type_t     type,
+                      socket_protocol_t protocol ) -> std::tuple< unique_socket, unique_socket >
+   {
+    int sockets[ 2 ];
+    int *pair = sockets;
+
+    Invoke( FailureFlagResult<int>(),
+            ::socketpair,
+            In( domain, type, protocol, pair ),
+            ThrowErrorFromErrno() );
+
+    return std::make_tuple( Seize< unique_socket >( Wrap< socket_t >( sockets[0] ) ),
+                            Seize< unique_socket >( Wrap< socket_t >( sockets[1] ) ) );
+   }
+
 void Po7::close( unique_socket s )
    {
     return Invoke( FailureFlagResult<int>(),
@@ -78,6 +96,26 @@ auto Po7::accept( socket_t socket, sockaddr& address, socklen_t& addressLength )
                    ThrowErrorFromErrno() );
    }
 
+#ifdef SOCK_NONBLOCK
+auto Po7::accept4( socket_t socket, socket_flags_t flags ) -> unique_socket
+   {
+    return Invoke( Result<unique_socket>() + FailsWhenFalse(),
+                   ::accept4,
+                   In( socket, nullptr, nullptr, flags ),
+                   ThrowErrorFromErrno() );
+   }
+
+auto Po7::accept4( socket_t socket, sockaddr& address, socklen_t& addressLength, socket_flags_t flags ) -> unique_socket
+   {
+    return Invoke( Result<unique_socket>() + FailsWhenFalse(),
+                   ::accept4,
+                   In( socket ),
+                   InOut( address, addressLength ),
+                   In( flags ),
+                   ThrowErrorFromErrno() );
+   }
+#endif
+
 void Po7::getsockname( socket_t socket, sockaddr& address, socklen_t& addressLength )
    {
     return Invoke( FailureFlagResult<int>(),
@@ -98,12 +136,17 @@ void Po7::getpeername( socket_t socket, sockaddr& address, socklen_t& addressLen
 
 namespace
    {
-    struct ssize_t_Result
+    struct int_ConnectResult
+       {
+        using ResultType                                                    = int;
+        bool CheckForFailure( int r ) const                                 { return r == -1 && errno != EINPROGRESS; }
+        std::tuple<> ThrownParts( int ) const                               { return std::tuple<>(); }
+        std::tuple< bool > ReturnedParts( int r ) const                     { return std::make_tuple( r == 0 ); }
+       };
+
+    struct AcceptFailed
        {
-        using ResultType                                                    = ::ssize_t;
-        bool CheckForFailure( ::ssize_t s ) const                           { return s == -1; }
-        std::tuple<> ThrownParts( ::ssize_t ) const                         { return std::tuple<>(); }
-        std::tuple< std::size_t > ReturnedParts( ::ssize_t s ) const        { return std::make_tuple( static_cast<std::size_t>( s ) ); }
+        bool operator()( const Po7::unique_socket& s ) const                { return !s && !Po7::ErrnoIsWouldBlock(); }
        };
    }
 
@@ -123,6 +166,131 @@ std::size_t Po7::recv( socket_t socket, void *buffer, std::size_t length, msg_fl
                    ThrowErrorFromErrno() );
    }
 
+std::size_t Po7::sendto( socket_t socket, const void *buffer, std::size_t length, msg_flags_t flags, const sockaddr& address, socklen_t addressLength )
+   {
+    return Invoke( ssize_t_Result(),
+                   ::sendto,
+                   In( socket, buffer, length, flags, address, addressLength ),
+                   ThrowErrorFromErrno() );
+   }
+
+std::size_t Po7::recvfrom( socket_t socket, void *buffer, std::size_t length, msg_flags_t flags, sockaddr& address, socklen_t& addressLength )
+   {
+    return Invoke( ssize_t_Result(),
+                   ::recvfrom,
+                   In( socket, buffer, length, flags ),
+                   InOut( address, addressLength ),
+                   ThrowErrorFromErrno() );
+   }
+
+auto Po7::MakeAnything( ThingToMake< msghdr >, iovec *vectors, std::size_t count ) -> msghdr
+   {
+    msghdr result;
+    std::memset( &result, 0, sizeof( result ) );
+    
+    result.msg_iov    = vectors;
+    result.msg_iovlen = count;
+    
+    return result;
+   }
+
+std::size_t Po7::sendmsg( socket_t socket, const msghdr& message, msg_flags_t flags )
+   {
+    return Invoke( ssize_t_Result(),
+                   ::sendmsg,
+                   In( socket, message, flags ),
+                   ThrowErrorFromErrno() );
+   }
+
+std::size_t Po7::recvmsg( socket_t socket, msghdr& message, msg_flags_t flags )
+   {
+    return Invoke( ssize_t_Result(),
+                   ::recvmsg,
+                   In( socket ),
+                   InOut( message ),
+                   In( flags ),
+                   ThrowErrorFromErrno() );
+   }
+
+auto Po7::try_send( socket_t socket, const void *buffer, std::size_t length, msg_flags_t flags ) -> try_result
+   {
+    return Invoke( ssize_t_TryResult(),
+                   ::send,
+                   In( socket, buffer, length, flags ),
+                   ThrowErrorFromErrno() );
+   }
+
+auto Po7::try_recv( socket_t socket, void *buffer, std::size_t length, msg_flags_t flags ) -> try_result
+   {
+    return Invoke( ssize_t_TryResult(),
+                   ::recv,
+                   In( socket, buffer, length, flags ),
+                   ThrowErrorFromErrno() );
+   }
+
+auto Po7::try_sendmsg( socket_t socket, const msghdr& message, msg_flags_t flags ) -> try_result
+   {
+    return Invoke( ssize_t_TryResult(),
+                   ::sendmsg,
+                   In( socket, message, flags ),
+                   ThrowErrorFromErrno() );
+   }
+
+auto Po7::try_recvmsg( socket_t socket, msghdr& message, msg_flags_t flags ) -> try_result
+   {
+    return Invoke( ssize_t_TryResult(),
+                   ::recvmsg,
+                   In( socket ),
+                   InOut( message ),
+                   In( flags ),
+                   ThrowErrorFromErrno() );
+   }
+
+bool Po7::try_connect( socket_t socket, const sockaddr& address, socklen_t addressLength )
+   {
+    return Invoke( int_ConnectResult(),
+                   ::connect,
+                   In( socket, address, addressLength ),
+                   ThrowErrorFromErrno() );
+   }
+
+auto Po7::try_accept( socket_t socket ) -> unique_socket
+   {
+    return Invoke( Result<unique_socket>() + FailsWhen( AcceptFailed() ),
+                   ::accept,
+                   In( socket, nullptr, nullptr ),
+                   ThrowErrorFromErrno() );
+   }
+
+auto Po7::try_accept( socket_t socket, sockaddr& address, socklen_t& addressLength ) -> unique_socket
+   {
+    return Invoke( Result<unique_socket>() + FailsWhen( AcceptFailed() ),
+                   ::accept,
+                   In( socket ),
+                   InOut( address, addressLength ),
+                   ThrowErrorFromErrno() );
+   }
+
+#ifdef SOCK_NONBLOCK
+auto Po7::try_accept( socket_t socket, socket_flags_t flags ) -> unique_socket
+   {
+    return Invoke( Result<unique_socket>() + FailsWhen( AcceptFailed() ),
+                   ::accept4,
+                   In( socket, nullptr, nullptr, flags ),
+                   ThrowErrorFromErrno() );
+   }
+
+auto Po7::try_accept( socket_t socket, sockaddr& address, socklen_t& addressLength, socket_flags_t flags ) -> unique_socket
+   {
+    return Invoke( Result<unique_socket>() + FailsWhen( AcceptFailed() ),
+                   ::accept4,
+                   In( socket ),
+                   InOut( address, addressLength ),
+                   In( flags ),
+                   ThrowErrorFromErrno() );
+   }
+#endif
+
 void Po7::shutdown( socket_t socket, shutdown_how_t how )
    {
     return Invoke( FailureFlagResult<int>(),
@@ -130,3 +298,184 @@ void Po7::shutdown( socket_t socket, shutdown_how_t how )
                    In( socket, how ),
                    ThrowErrorFromErrno() );
    }
+
+void Po7::setsockopt( socket_t socket, int level, int name, const void *value, socklen_t length )
+   {
+    return Invoke( FailureFlagResult<int>(),
+                   ::setsockopt,
+                   In( socket, level, name, value, length ),
+                   ThrowErrorFromErrno() );
+   }
+
+void Po7::getsockopt( socket_t socket, int level, int name, void *value, socklen_t& length )
+   {
+    return Invoke( FailureFlagResult<int>(),
+                   ::getsockopt,
+                   In( socket, level, name, value ),
+                   InOut( length ),
+                   ThrowErrorFromErrno() );
+   }
+
+void Po7::setsockopt( socket_t socket, int level, int name, const void *value, socklen_t length, std::error_code& error )
+   {
+    return Invoke( FailureFlagResult<int>(),
+                   ::setsockopt,
+                   In( socket, level, name, value, length ),
+                   ReportErrorFromErrno( error ) );
+   }
+
+void Po7::getsockopt( socket_t socket, int level, int name, void *value, socklen_t& length, std::error_code& error )
+   {
+    return Invoke( FailureFlagResult<int>(),
+                   ::getsockopt,
+                   In( socket, level, name, value ),
+                   InOut( length ),
+                   ReportErrorFromErrno( error ) );
+   }
+
+auto Po7::socket( socket_domain_t   domain,
+                  socket_type_t     type,
+                  socket_protocol_t protocol,
+                  std::error_code&  error ) -> unique_socket
+   {
+    return Invoke( Result< unique_socket >() + FailsWhenFalse(),
+                   ::socket,
+                   In( domain, type, protocol ),
+                   ReportErrorFromErrno( error ) );
+   }
+
+void Po7::close( unique_socket s, std::error_code& error )
+   {
+    return Invoke( FailureFlagResult<int>(),
+                   ::close,
+                   In( std::move( s ) ),
+                   ReportErrorFromErrno( error ) );
+   }
+
+void Po7::listen( socket_t socket, int backlog, std::error_code& error )
+   {
+    return Invoke( FailureFlagResult<int>(),
+                   ::listen,
+                   In( socket, backlog ),
+                   ReportErrorFromErrno( error ) );
+   }
+
+void Po7::bind( socket_t socket, const sockaddr& address, socklen_t addressLength, std::error_code& error )
+   {
+    return Invoke( FailureFlagResult<int>(),
+                   ::bind,
+                   In( socket, address, addressLength ),
+                   ReportErrorFromErrno( error ) );
+   }
+
+void Po7::connect( socket_t socket, const sockaddr& address, socklen_t addressLength, std::error_code& error )
+   {
+    return Invoke( FailureFlagResult<int>(),
+                   ::connect,
+                   In( socket, address, addressLength ),
+                   ReportErrorFromErrno( error ) );
+   }
+
+bool Po7::try_connect( socket_t socket, const sockaddr& address, socklen_t addressLength, std::error_code& error )
+   {
+    return Invoke( int_ConnectResult(),
+                   ::connect,
+                   In( socket, address, addressLength ),
+                   ReportErrorFromErrno( error ) );
+   }
+
+auto Po7::accept( socket_t socket, std::error_code& error ) -> unique_socket
+   {
+    return Invoke( Result<unique_socket>() + FailsWhenFalse(),
+                   ::accept,
+                   In( socket, nullptr, nullptr ),
+                   ReportErrorFromErrno( error ) );
+   }
+
+auto Po7::accept( socket_t socket, sockaddr& address, socklen_t& addressLength, std::error_code& error ) -> unique_socket
+   {
+    return Invoke( Result<unique_socket>() + FailsWhenFalse(),
+                   ::accept,
+                   In( socket ),
+                   InOut( address, addressLength ),
+                   ReportErrorFromErrno( error ) );
+   }
+
+#ifdef SOCK_NONBLOCK
+auto Po7::accept4( socket_t socket, socket_flags_t flags, std::error_code& error ) -> unique_socket
+   {
+    return Invoke( Result<unique_socket>() + FailsWhenFalse(),
+                   ::accept4,
+                   In( socket, nullptr, nullptr, flags ),
+                   ReportErrorFromErrno( error ) );
+   }
+
+auto Po7::accept4( socket_t socket, sockaddr& address, socklen_t& addressLength, socket_flags_t flags, std::error_code& error ) -> unique_socket
+   {
+    return Invoke( Result<unique_socket>() + FailsWhenFalse(),
+                   ::accept4,
+                   In( socket ),
+                   InOut( address, addressLength ),
+                   In( flags ),
+                   ReportErrorFromErrno( error ) );
+   }
+#endif
+
+std::size_t Po7::send( socket_t socket, const void *buffer, std::size_t length, msg_flags_t flags, std::error_code& error )
+   {
+    return Invoke( ssize_t_Result(),
+                   ::send,
+                   In( socket, buffer, length, flags ),
+                   ReportErrorFromErrno( error ) );
+   }
+
+std::size_t Po7::recv( socket_t socket, void *buffer, std::size_t length, msg_flags_t flags, std::error_code& error )
+   {
+    return Invoke( ssize_t_Result(),
+                   ::recv,
+                   In( socket, buffer, length, flags ),
+                   ReportErrorFromErrno( error ) );
+   }
+
+std::size_t Po7::sendto( socket_t socket, const void *buffer, std::size_t length, msg_flags_t flags, const sockaddr& address, socklen_t addressLength, std::error_code& error )
+   {
+    return Invoke( ssize_t_Result(),
+                   ::sendto,
+                   In( socket, buffer, length, flags, address, addressLength ),
+                   ReportErrorFromErrno( error ) );
+   }
+
+std::size_t Po7::recvfrom( socket_t socket, void *buffer, std::size_t length, msg_flags_t flags, sockaddr& address, socklen_t& addressLength, std::error_code& error )
+   {
+    return Invoke( ssize_t_Result(),
+                   ::recvfrom,
+                   In( socket, buffer, length, flags ),
+                   InOut( address, addressLength ),
+                   ReportErrorFromErrno( error ) );
+   }
+
+std::size_t Po7::sendmsg( socket_t socket, const msghdr& message, msg_flags_t flags, std::error_code& error )
+   {
+    return Invoke( ssize_t_Result(),
+                   ::sendmsg,
+                   In( socket, message, flags ),
+                   ReportErrorFromErrno( error ) );
+   }
+
+std::size_t Po7::recvmsg( socket_t socket, msghdr& message, msg_flags_t flags, std::error_code& error )
+   {
+    return Invoke( ssize_t_Result(),
+                   ::recvmsg,
+                   In( socket ),
+                   InOut( message ),
+                   In( flags ),
+                   ReportErrorFromErrno( error ) );
+   }
+
+void Po7::shutdown( socket_t socket, shutdown_how_t how, std::error_code& error )
+   {
+    return Invoke( FailureFlagResult<int>(),
+                   ::shutdown,
+                   In( socket, how ),
+                   ReportErrorFromErrno( error ) );
+   }
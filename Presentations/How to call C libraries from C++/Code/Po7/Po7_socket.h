@@ -11,9 +11,13 @@
 
 #include "Po7_Basics.h"
 #include "Po7_is_sockaddr.h"
+#include "Po7_uio.h"
+#include "Po7_unistd.h"
 
 #include "bufferlike.h"
 
+#include <system_error>
+#include <tuple>
 #include <type_traits>
 
 #include <unistd.h>
@@ -27,6 +31,7 @@ namespace Po7
             constexpr int operator()() const            { return -1; }
             static const bool hasEquality               = true;
             static const bool hasComparison             = true;
+            constexpr operator FileDescriptorTag() const { return FileDescriptorTag(); }
            };
 
         using socket_t = PlusPlus::Boxed< SocketTag >;
@@ -39,6 +44,7 @@ namespace Po7
             static const bool hasEquality               = true;
             static const bool hasComparison             = true;
             constexpr operator SocketTag() const        { return SocketTag(); }
+            constexpr operator FileDescriptorTag() const { return FileDescriptorTag(); }
            };
 
         template < socket_domain_t domain >
@@ -57,6 +63,7 @@ namespace Po7
            {
             using pointer = PlusPlus::PointerToValue< socket_t >;
             void operator()( pointer s ) const;
+            operator FileDescriptorDeleter() const  { return FileDescriptorDeleter(); }
            };
 
         using unique_socket = std::unique_ptr< const socket_t, SocketDeleter >;
@@ -68,6 +75,7 @@ namespace Po7
             using pointer = PlusPlus::PointerToValue< socket_in_domain<domain> >;
             void operator()( pointer s ) const      { SocketDeleter()( s ); }
             operator SocketDeleter() const          { return SocketDeleter(); }
+            operator FileDescriptorDeleter() const  { return FileDescriptorDeleter(); }
            };
 
         template < socket_domain_t domain >
@@ -92,6 +100,26 @@ namespace Po7
             const socket_type_t sock_raw   = socket_type_t( SOCK_RAW );
         #endif
 
+    // socket_flags_t may be or-ed into a socket_type_t, and is the last parameter to accept4()
+        struct SocketFlagsTag
+           {
+            constexpr int operator()() const                { return 0; }
+            static const bool hasEquality                   = true;
+            static const bool hasBitwise                    = true;
+           };
+
+        using socket_flags_t = PlusPlus::Boxed< SocketFlagsTag >;
+
+        #ifdef SOCK_NONBLOCK
+            const socket_flags_t sock_nonblock = socket_flags_t( SOCK_NONBLOCK );
+            const socket_flags_t sock_cloexec  = socket_flags_t( SOCK_CLOEXEC );
+        #endif
+
+        inline socket_type_t operator|( socket_type_t type, socket_flags_t flags )
+           {
+            return Wrap< socket_type_t >( Unwrap( type ) | Unwrap( flags ) );
+           }
+
     // socket_protocol_t is the third paremeter to socket()
         enum class socket_protocol_t: int;
         template <> struct Wrapper< socket_protocol_t >: PlusPlus::EnumWrapper< socket_protocol_t > {};
@@ -104,12 +132,32 @@ namespace Po7
         
         void close( unique_socket s );
 
+        template < socket_domain_t domain >
+        void close( unique_socket_in_domain<domain> s )
+           {
+            close( unique_socket( std::move( s ) ) );
+           }
+
     // The template form of socket produces a socket typed to its domain, making address operations easier.
         template < socket_domain_t domain >
         unique_socket_in_domain< domain > socket( socket_type_t type, socket_protocol_t protocol )
            {
             return domain_cast< domain >( socket( domain, type, protocol ) );
            }
+
+    // socketpair makes two sockets connected to each other.
+        std::tuple< unique_socket, unique_socket > socketpair( socket_domain_t   domain,
+                                                               socket_type_t     type,
+                                                               socket_protocol_t protocol );
+
+        template < socket_domain_t domain >
+        auto socketpair( socket_type_t type, socket_protocol_t protocol )
+        -> std::tuple< unique_socket_in_domain< domain >, unique_socket_in_domain< domain > >
+           {
+            auto pair = socketpair( domain, type, protocol );
+            return std::make_tuple( domain_cast< domain >( std::move( std::get<0>( pair ) ) ),
+                                    domain_cast< domain >( std::move( std::get<1>( pair ) ) ) );
+           }
     
     
 
@@ -133,20 +181,20 @@ namespace Po7
         template < socket_domain_t domain >
         void bind( socket_in_domain<domain> s, const sockaddr_type<domain>& a )
            {
-            bind( s, sockaddr_cast< const sockaddr& >( a ), sizeof( a ) );
+            bind( s, sockaddr_cast< const sockaddr& >( a ), sockaddr_length( a ) );
            }
 
         template < socket_domain_t domain >
         void connect( socket_in_domain<domain> s, const sockaddr_type<domain>& a )
            {
-            connect( s, sockaddr_cast< const sockaddr& >( a ), sizeof( a ) );
+            connect( s, sockaddr_cast< const sockaddr& >( a ), sockaddr_length( a ) );
            }
 
         template < socket_domain_t domain >
         auto accept( socket_in_domain<domain> s )
         -> std::tuple< unique_socket_in_domain<domain>, sockaddr_type<domain> >
            {
-            sockaddr_type< domain > address;
+            sockaddr_type< domain > address = sockaddr_type< domain >();
             socklen_t addressLength = sizeof( address );
             sockaddr& genericAddress = sockaddr_cast< sockaddr& >( address );
             
@@ -158,11 +206,33 @@ namespace Po7
             return std::make_tuple( domain_cast<domain>( std::move( accepted ) ), address );
            }
         
+    #ifdef SOCK_NONBLOCK
+    // accept4 also sets flags on the accepted socket, sparing a call to fcntl.
+        unique_socket accept4( socket_t, socket_flags_t );
+        unique_socket accept4( socket_t, sockaddr&, socklen_t&, socket_flags_t );
+
+        template < socket_domain_t domain >
+        auto accept4( socket_in_domain<domain> s, socket_flags_t flags )
+        -> std::tuple< unique_socket_in_domain<domain>, sockaddr_type<domain> >
+           {
+            sockaddr_type< domain > address = sockaddr_type< domain >();
+            socklen_t addressLength = sizeof( address );
+            sockaddr& genericAddress = sockaddr_cast< sockaddr& >( address );
+            
+            unique_socket accepted  = accept4( s, genericAddress, addressLength, flags );
+            
+            if ( Wrap<socket_domain_t>( genericAddress.sa_family ) != domain )
+                throw std::domain_error( "Socket not in the expected domain" );
+            
+            return std::make_tuple( domain_cast<domain>( std::move( accepted ) ), address );
+           }
+    #endif
+        
         template < socket_domain_t domain >
         auto getsockname( socket_in_domain<domain> s )
         -> sockaddr_type< domain >
            {
-            sockaddr_type< domain > address;
+            sockaddr_type< domain > address = sockaddr_type< domain >();
             socklen_t addressLength = sizeof( address );
             sockaddr& genericAddress = sockaddr_cast< sockaddr& >( address );
 
@@ -178,7 +248,7 @@ namespace Po7
         auto getpeername( socket_in_domain<domain> s )
         -> sockaddr_type< domain >
            {
-            sockaddr_type< domain > address;
+            sockaddr_type< domain > address = sockaddr_type< domain >();
             socklen_t addressLength = sizeof( address );
             sockaddr& genericAddress = sockaddr_cast< sockaddr& >( address );
 
@@ -205,6 +275,17 @@ namespace Po7
         const msg_flags_t msg_oob      = msg_flags_t( MSG_OOB );
         const msg_flags_t msg_peek     = msg_flags_t( MSG_PEEK );
         const msg_flags_t msg_waitall  = msg_flags_t( MSG_WAITALL );
+        const msg_flags_t msg_nosignal = msg_flags_t( MSG_NOSIGNAL );
+        #ifdef MSG_DONTWAIT
+            const msg_flags_t msg_dontwait = msg_flags_t( MSG_DONTWAIT );
+        #endif
+        #ifdef MSG_CMSG_CLOEXEC
+            const msg_flags_t msg_cmsg_cloexec = msg_flags_t( MSG_CMSG_CLOEXEC );
+        #endif
+        #ifdef MSG_ZEROCOPY
+            const msg_flags_t msg_zerocopy = msg_flags_t( MSG_ZEROCOPY );
+            const msg_flags_t msg_errqueue = msg_flags_t( MSG_ERRQUEUE );
+        #endif
 
     // send and recv send and receive the data
         std::size_t send( socket_t, const void *buffer, std::size_t length, msg_flags_t = msg_flags_t() );
@@ -225,6 +306,157 @@ namespace Po7
            }
         
 
+    // sendto and recvfrom are for datagrams, which carry their addresses with them
+        std::size_t sendto(   socket_t, const void *buffer, std::size_t length, msg_flags_t, const sockaddr&, socklen_t );
+        std::size_t recvfrom( socket_t,       void *buffer, std::size_t length, msg_flags_t,       sockaddr&, socklen_t& );
+
+        template < socket_domain_t domain, class Buffer >
+        auto sendto( socket_in_domain<domain> s, const Buffer& b, const sockaddr_type<domain>& a, msg_flags_t f = msg_flags_t() )
+        -> typename std::enable_if< PlusPlus::stdish::is_bufferlike<Buffer>::value, std::size_t >::type
+           {
+            return sendto( s, PlusPlus::stdish::bufferlike_data( b ), PlusPlus::stdish::bufferlike_size( b ), f,
+                           sockaddr_cast< const sockaddr& >( a ), sockaddr_length( a ) );
+           }
+
+        template < socket_domain_t domain, class Buffer >
+        auto recvfrom( socket_in_domain<domain> s, Buffer& b, msg_flags_t f = msg_flags_t() )
+        -> typename std::enable_if< PlusPlus::stdish::is_bufferlike<Buffer>::value, std::tuple< std::size_t, sockaddr_type<domain> > >::type
+           {
+            sockaddr_type< domain > address = sockaddr_type< domain >();
+            socklen_t addressLength = sizeof( address );
+            sockaddr& genericAddress = sockaddr_cast< sockaddr& >( address );
+            
+            std::size_t length = recvfrom( s, PlusPlus::stdish::bufferlike_data( b ), PlusPlus::stdish::bufferlike_size( b ), f,
+                                           genericAddress, addressLength );
+            
+            if ( Wrap<socket_domain_t>( genericAddress.sa_family ) != domain )
+                throw std::domain_error( "Socket not in the expected domain" );
+            
+            return std::make_tuple( length, address );
+           }
+
+
+    // sendmsg and recvmsg gather from and scatter to several buffers in one call.
+        using ::msghdr;
+        
+        msghdr MakeAnything( ThingToMake< msghdr >, iovec *vectors, std::size_t count );
+
+        std::size_t sendmsg( socket_t, const msghdr&, msg_flags_t = msg_flags_t() );
+        std::size_t recvmsg( socket_t,       msghdr&, msg_flags_t = msg_flags_t() );
+
+    // They also take sequences of buffers: tuples (e.g., from std::tie), arrays, or vectors of bufferlike objects.
+    // The iovecs are built on the stack.
+        template < class Sequence >
+        auto sendmsg( socket_t s, const Sequence& buffers, msg_flags_t f = msg_flags_t() )
+        -> typename std::enable_if< PlusPlus::stdish::is_buffer_sequence<Sequence>::value, std::size_t >::type
+           {
+            iovec_array< const Sequence > vectors( buffers );
+            return sendmsg( s, Make< msghdr >( vectors.data(), vectors.size() ), f );
+           }
+
+        template < class Sequence >
+        auto recvmsg( socket_t s, Sequence& buffers, msg_flags_t f = msg_flags_t() )
+        -> typename std::enable_if< PlusPlus::stdish::is_buffer_sequence<Sequence>::value, std::size_t >::type
+           {
+            iovec_array< Sequence > vectors( buffers );
+            msghdr message = Make< msghdr >( vectors.data(), vectors.size() );
+            return recvmsg( s, message, f );
+           }
+
+    // The try_ forms are for non-blocking sockets.  When the operation would block, they say so
+    // in their results rather than throwing, so a busy server doesn't build and unwind an exception
+    // every time a socket runs dry.  Other errors are still thrown.
+
+    // try_result is either a count of bytes transferred, or a note that the operation would block.
+    // A default-constructed try_result is the latter.
+        class try_result
+           {
+            private:
+                std::size_t transferred;
+                bool        blocked;
+
+            public:
+                try_result()                                : transferred( 0 ), blocked( true )  {}
+                explicit try_result( std::size_t n )        : transferred( n ), blocked( false ) {}
+
+                bool would_block() const                    { return blocked; }
+                std::size_t size() const                    { return transferred; }
+
+                explicit operator bool() const              { return !blocked; }
+           };
+
+        try_result try_send( socket_t, const void *buffer, std::size_t length, msg_flags_t = msg_flags_t() );
+        try_result try_recv( socket_t,       void *buffer, std::size_t length, msg_flags_t = msg_flags_t() );
+
+        template < class Buffer >
+        auto try_send( socket_t s, const Buffer& b, msg_flags_t f = msg_flags_t() )
+        -> typename std::enable_if< PlusPlus::stdish::is_bufferlike<Buffer>::value, try_result >::type
+           {
+            return try_send( s, PlusPlus::stdish::bufferlike_data( b ), PlusPlus::stdish::bufferlike_size( b ), f );
+           }
+        
+        template < class Buffer >
+        auto try_recv( socket_t s, Buffer& b, msg_flags_t f = msg_flags_t() )
+        -> typename std::enable_if< PlusPlus::stdish::is_bufferlike<Buffer>::value, try_result >::type
+           {
+            return try_recv( s, PlusPlus::stdish::bufferlike_data( b ), PlusPlus::stdish::bufferlike_size( b ), f );
+           }
+
+        try_result try_sendmsg( socket_t, const msghdr&, msg_flags_t = msg_flags_t() );
+        try_result try_recvmsg( socket_t,       msghdr&, msg_flags_t = msg_flags_t() );
+
+    // try_accept produces a null socket when no connection is waiting.
+        unique_socket try_accept( socket_t );
+        unique_socket try_accept( socket_t, sockaddr&, socklen_t& );
+    #ifdef SOCK_NONBLOCK
+        unique_socket try_accept( socket_t, socket_flags_t );
+        unique_socket try_accept( socket_t, sockaddr&, socklen_t&, socket_flags_t );
+    #endif
+
+        template < socket_domain_t domain >
+        auto try_accept( socket_in_domain<domain> s )
+        -> std::tuple< unique_socket_in_domain<domain>, sockaddr_type<domain> >
+           {
+            sockaddr_type< domain > address = sockaddr_type< domain >();
+            socklen_t addressLength = sizeof( address );
+            sockaddr& genericAddress = sockaddr_cast< sockaddr& >( address );
+            
+            unique_socket accepted  = try_accept( s, genericAddress, addressLength );
+            
+            if ( accepted && Wrap<socket_domain_t>( genericAddress.sa_family ) != domain )
+                throw std::domain_error( "Socket not in the expected domain" );
+            
+            return std::make_tuple( domain_cast<domain>( std::move( accepted ) ), address );
+           }
+
+    #ifdef SOCK_NONBLOCK
+        template < socket_domain_t domain >
+        auto try_accept( socket_in_domain<domain> s, socket_flags_t flags )
+        -> std::tuple< unique_socket_in_domain<domain>, sockaddr_type<domain> >
+           {
+            sockaddr_type< domain > address = sockaddr_type< domain >();
+            socklen_t addressLength = sizeof( address );
+            sockaddr& genericAddress = sockaddr_cast< sockaddr& >( address );
+            
+            unique_socket accepted  = try_accept( s, genericAddress, addressLength, flags );
+            
+            if ( accepted && Wrap<socket_domain_t>( genericAddress.sa_family ) != domain )
+                throw std::domain_error( "Socket not in the expected domain" );
+            
+            return std::make_tuple( domain_cast<domain>( std::move( accepted ) ), address );
+           }
+    #endif
+
+    // try_connect starts connecting a non-blocking socket.  It returns true if the connection was made at once,
+    // or false if it's in progress; the socket becomes writable when the attempt ends, and so_error then
+    // says how it went.
+        bool try_connect( socket_t, const sockaddr&, socklen_t );
+
+        template < socket_domain_t domain >
+        bool try_connect( socket_in_domain<domain> s, const sockaddr_type<domain>& a )
+           {
+            return try_connect( s, sockaddr_cast< const sockaddr& >( a ), sockaddr_length( a ) );
+           }
 
     // shutdown_how_t is a parameter to shutdown()
         enum class shutdown_how_t: int {};
@@ -236,6 +468,118 @@ namespace Po7
 
     // shutdown ends communication on a socket
         void shutdown( socket_t, shutdown_how_t );
+
+
+    // setsockopt and getsockopt take the option as raw bytes in their basic form.
+        void setsockopt( socket_t, int level, int name, const void *value, socklen_t length );
+        void getsockopt( socket_t, int level, int name,       void *value, socklen_t& length );
+
+
+    // These forms report errors by setting a std::error_code instead of throwing, for errors like refused
+    // connections and resets that a server sees all the time.  On failure they return a null socket or
+    // a count of zero; on success they clear the error_code.
+        unique_socket socket( socket_domain_t, socket_type_t, socket_protocol_t, std::error_code& );
+        void close( unique_socket, std::error_code& );
+        void listen( socket_t, int backlog, std::error_code& );
+        void bind( socket_t, const sockaddr&, socklen_t, std::error_code& );
+        void connect( socket_t, const sockaddr&, socklen_t, std::error_code& );
+        bool try_connect( socket_t, const sockaddr&, socklen_t, std::error_code& );
+        unique_socket accept( socket_t, std::error_code& );
+        unique_socket accept( socket_t, sockaddr&, socklen_t&, std::error_code& );
+    #ifdef SOCK_NONBLOCK
+        unique_socket accept4( socket_t, socket_flags_t, std::error_code& );
+        unique_socket accept4( socket_t, sockaddr&, socklen_t&, socket_flags_t, std::error_code& );
+    #endif
+        std::size_t send( socket_t, const void *buffer, std::size_t length, msg_flags_t, std::error_code& );
+        std::size_t recv( socket_t,       void *buffer, std::size_t length, msg_flags_t, std::error_code& );
+        std::size_t sendto(   socket_t, const void *buffer, std::size_t length, msg_flags_t, const sockaddr&, socklen_t,  std::error_code& );
+        std::size_t recvfrom( socket_t,       void *buffer, std::size_t length, msg_flags_t,       sockaddr&, socklen_t&, std::error_code& );
+        std::size_t sendmsg( socket_t, const msghdr&, msg_flags_t, std::error_code& );
+        std::size_t recvmsg( socket_t,       msghdr&, msg_flags_t, std::error_code& );
+        void shutdown( socket_t, shutdown_how_t, std::error_code& );
+        void setsockopt( socket_t, int level, int name, const void *value, socklen_t length, std::error_code& );
+        void getsockopt( socket_t, int level, int name,       void *value, socklen_t& length, std::error_code& );
+
+        template < socket_domain_t domain >
+        void close( unique_socket_in_domain<domain> s, std::error_code& error )
+           {
+            close( unique_socket( std::move( s ) ), error );
+           }
+
+        template < socket_domain_t domain >
+        unique_socket_in_domain< domain > socket( socket_type_t type, socket_protocol_t protocol, std::error_code& error )
+           {
+            return domain_cast< domain >( socket( domain, type, protocol, error ) );
+           }
+
+        template < socket_domain_t domain >
+        void bind( socket_in_domain<domain> s, const sockaddr_type<domain>& a, std::error_code& error )
+           {
+            bind( s, sockaddr_cast< const sockaddr& >( a ), sockaddr_length( a ), error );
+           }
+
+        template < socket_domain_t domain >
+        void connect( socket_in_domain<domain> s, const sockaddr_type<domain>& a, std::error_code& error )
+           {
+            connect( s, sockaddr_cast< const sockaddr& >( a ), sockaddr_length( a ), error );
+           }
+
+        template < socket_domain_t domain >
+        auto accept( socket_in_domain<domain> s, std::error_code& error )
+        -> std::tuple< unique_socket_in_domain<domain>, sockaddr_type<domain> >
+           {
+            sockaddr_type< domain > address = sockaddr_type< domain >();
+            socklen_t addressLength = sizeof( address );
+            sockaddr& genericAddress = sockaddr_cast< sockaddr& >( address );
+            
+            unique_socket accepted  = accept( s, genericAddress, addressLength, error );
+            
+            if ( accepted && Wrap<socket_domain_t>( genericAddress.sa_family ) != domain )
+               {
+                accepted.reset();
+                error = std::make_error_code( std::errc::address_family_not_supported );
+               }
+            
+            return std::make_tuple( domain_cast<domain>( std::move( accepted ) ), address );
+           }
+
+        inline std::size_t send( socket_t s, const void *buffer, std::size_t length, std::error_code& error )
+           {
+            return send( s, buffer, length, msg_flags_t(), error );
+           }
+
+        inline std::size_t recv( socket_t s, void *buffer, std::size_t length, std::error_code& error )
+           {
+            return recv( s, buffer, length, msg_flags_t(), error );
+           }
+
+        template < class Buffer >
+        auto send( socket_t s, const Buffer& b, msg_flags_t f, std::error_code& error )
+        -> typename std::enable_if< PlusPlus::stdish::is_bufferlike<Buffer>::value, std::size_t >::type
+           {
+            return send( s, PlusPlus::stdish::bufferlike_data( b ), PlusPlus::stdish::bufferlike_size( b ), f, error );
+           }
+
+        template < class Buffer >
+        auto recv( socket_t s, Buffer& b, msg_flags_t f, std::error_code& error )
+        -> typename std::enable_if< PlusPlus::stdish::is_bufferlike<Buffer>::value, std::size_t >::type
+           {
+            return recv( s, PlusPlus::stdish::bufferlike_data( b ), PlusPlus::stdish::bufferlike_size( b ), f, error );
+           }
+
+        template < class Buffer >
+        auto send( socket_t s, const Buffer& b, std::error_code& error )
+        -> typename std::enable_if< PlusPlus::stdish::is_bufferlike<Buffer>::value, std::size_t >::type
+           {
+            return send( s, b, msg_flags_t(), error );
+           }
+
+        template < class Buffer >
+        auto recv( socket_t s, Buffer& b, std::error_code& error )
+        -> typename std::enable_if< PlusPlus::stdish::is_bufferlike<Buffer>::value, std::size_t >::type
+           {
+            return recv( s, b, msg_flags_t(), error );
+           }
    }
 
 #endif
@@ -0,0 +1,199 @@
+//
+//  Po7_sockopt.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_SOCKOPT_H
+#define PO7_SOCKOPT_H
+
+#include "Po7_socket.h"
+
+#include <chrono>
+#include <system_error>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/time.h>
+
+namespace Po7
+   {
+    // A socket option is a traits type giving its level, its name, the type of its value, and how that value
+    // is stored.  setsockopt<option> and getsockopt<option> use the traits, so a value of the wrong type, or
+    // setting an option that can only be read, fails to compile:
+    //
+    //      Po7::setsockopt< Po7::tcp_nodelay >( *socket, true );
+    //      Po7::setsockopt< Po7::so_rcvbuf >( *socket, Po7::buffer_size_t( 1 << 20 ) );
+    //      auto timeout = Po7::getsockopt< Po7::so_rcvtimeo >( *socket );      // std::chrono::microseconds
+
+        template < class Option >
+        void setsockopt( socket_t s, const typename Option::value_type& value )
+           {
+            static_assert( Option::settable, "This socket option can only be read" );
+            typename Option::raw_type raw = Option::ToRaw( value );
+            setsockopt( s, Option::level, Option::name, &raw, sizeof( raw ) );
+           }
+
+        template < class Option >
+        typename Option::value_type getsockopt( socket_t s )
+           {
+            typename Option::raw_type raw = typename Option::raw_type();
+            socklen_t length = sizeof( raw );
+            getsockopt( s, Option::level, Option::name, &raw, length );
+            return Option::FromRaw( raw );
+           }
+
+    // These forms report errors through the error_code, as in Po7_socket.h; a failed getsockopt returns the
+    // option's value for zero.
+        template < class Option >
+        void setsockopt( socket_t s, const typename Option::value_type& value, std::error_code& error )
+           {
+            static_assert( Option::settable, "This socket option can only be read" );
+            typename Option::raw_type raw = Option::ToRaw( value );
+            setsockopt( s, Option::level, Option::name, &raw, sizeof( raw ), error );
+           }
+
+        template < class Option >
+        typename Option::value_type getsockopt( socket_t s, std::error_code& error )
+           {
+            typename Option::raw_type raw = typename Option::raw_type();
+            socklen_t length = sizeof( raw );
+            getsockopt( s, Option::level, Option::name, &raw, length, error );
+            return Option::FromRaw( error ? typename Option::raw_type() : raw );
+           }
+
+
+    // These templates describe the usual ways options are stored.
+        template < int theLevel, int theName, bool isSettable = true >
+        struct OptionBase
+           {
+            static const int  level    = theLevel;
+            static const int  name     = theName;
+            static const bool settable = isSettable;
+           };
+
+        template < int level, int name >
+        struct BoolOption: OptionBase< level, name >
+           {
+            using value_type = bool;
+            using raw_type   = int;
+            static raw_type ToRaw( bool b )                 { return b ? 1 : 0; }
+            static bool FromRaw( raw_type r )               { return r != 0; }
+           };
+
+        template < int level, int name >
+        struct IntOption: OptionBase< level, name >
+           {
+            using value_type = int;
+            using raw_type   = int;
+            static raw_type ToRaw( int i )                  { return i; }
+            static int FromRaw( raw_type r )                { return r; }
+           };
+
+        template < int level, int name, class Box >
+        struct BoxedOption: OptionBase< level, name >
+           {
+            using value_type = Box;
+            using raw_type   = typename Box::ValueType;
+            static raw_type ToRaw( const Box& b )           { return b.Get(); }
+            static Box FromRaw( raw_type r )                { return Box( r ); }
+           };
+
+        template < int level, int name, class Duration, class Raw = int >
+        struct DurationOption: OptionBase< level, name >
+           {
+            using value_type = Duration;
+            using raw_type   = Raw;
+            static raw_type ToRaw( Duration d )             { return static_cast< raw_type >( d.count() ); }
+            static Duration FromRaw( raw_type r )           { return Duration( r ); }
+           };
+
+        template < int level, int name >
+        struct TimevalOption: OptionBase< level, name >
+           {
+            using value_type = std::chrono::microseconds;
+            using raw_type   = ::timeval;
+
+            static raw_type ToRaw( std::chrono::microseconds d )
+               {
+                raw_type result;
+                result.tv_sec  = static_cast< decltype( result.tv_sec  ) >( d.count() / 1000000 );
+                result.tv_usec = static_cast< decltype( result.tv_usec ) >( d.count() % 1000000 );
+                return result;
+               }
+
+            static std::chrono::microseconds FromRaw( const raw_type& t )
+               {
+                return std::chrono::seconds( t.tv_sec ) + std::chrono::microseconds( t.tv_usec );
+               }
+           };
+
+
+    // buffer_size_t is a socket buffer size in bytes.  Linux doubles the size set, to allow for bookkeeping,
+    // and reports the doubled size.
+        struct BufferSizeTag
+           {
+            constexpr int operator()() const                { return 0; }
+            static const bool hasEquality                   = true;
+            static const bool hasComparison                 = true;
+           };
+
+        using buffer_size_t = PlusPlus::Boxed< BufferSizeTag >;
+
+
+    // Options at the socket level
+        struct so_reuseaddr:  BoolOption< SOL_SOCKET, SO_REUSEADDR > {};
+        struct so_keepalive:  BoolOption< SOL_SOCKET, SO_KEEPALIVE > {};
+        struct so_rcvbuf:     BoxedOption< SOL_SOCKET, SO_RCVBUF, buffer_size_t > {};
+        struct so_sndbuf:     BoxedOption< SOL_SOCKET, SO_SNDBUF, buffer_size_t > {};
+        struct so_rcvtimeo:   TimevalOption< SOL_SOCKET, SO_RCVTIMEO > {};
+        struct so_sndtimeo:   TimevalOption< SOL_SOCKET, SO_SNDTIMEO > {};
+
+        #ifdef SO_REUSEPORT
+            struct so_reuseport:  BoolOption< SOL_SOCKET, SO_REUSEPORT > {};
+        #endif
+        #ifdef SO_BUSY_POLL
+            struct so_busy_poll:  DurationOption< SOL_SOCKET, SO_BUSY_POLL, std::chrono::microseconds > {};
+        #endif
+        #ifdef SO_ZEROCOPY
+            struct so_zerocopy:   BoolOption< SOL_SOCKET, SO_ZEROCOPY > {};
+        #endif
+
+    // so_error reads and clears the socket's pending error, such as the result of a non-blocking connect.
+        struct so_error: OptionBase< SOL_SOCKET, SO_ERROR, false >
+           {
+            using value_type = std::error_code;
+            using raw_type   = int;
+            static std::error_code FromRaw( raw_type r )    { return Wrap< std::error_code >( r ); }
+           };
+
+    // Options for TCP
+        struct tcp_nodelay:   BoolOption< IPPROTO_TCP, TCP_NODELAY > {};
+
+        #ifdef TCP_CORK
+            struct tcp_cork:          BoolOption< IPPROTO_TCP, TCP_CORK > {};
+        #endif
+        #ifdef TCP_QUICKACK
+            struct tcp_quickack:      BoolOption< IPPROTO_TCP, TCP_QUICKACK > {};
+        #endif
+        #ifdef TCP_KEEPIDLE
+            struct tcp_keepidle:      DurationOption< IPPROTO_TCP, TCP_KEEPIDLE,  std::chrono::seconds > {};
+            struct tcp_keepintvl:     DurationOption< IPPROTO_TCP, TCP_KEEPINTVL, std::chrono::seconds > {};
+            struct tcp_keepcnt:       IntOption< IPPROTO_TCP, TCP_KEEPCNT > {};
+        #endif
+        #ifdef TCP_USER_TIMEOUT
+            struct tcp_user_timeout:  DurationOption< IPPROTO_TCP, TCP_USER_TIMEOUT, std::chrono::milliseconds, unsigned int > {};
+        #endif
+        #ifdef TCP_DEFER_ACCEPT
+            struct tcp_defer_accept:  DurationOption< IPPROTO_TCP, TCP_DEFER_ACCEPT, std::chrono::seconds > {};
+        #endif
+        #ifdef TCP_FASTOPEN
+            struct tcp_fastopen:      IntOption< IPPROTO_TCP, TCP_FASTOPEN > {};      // the queue length for pending fast opens
+        #endif
+
+    // Options for IPv6
+        struct ipv6_v6only:   BoolOption< IPPROTO_IPV6, IPV6_V6ONLY > {};
+   }
+
+#endif
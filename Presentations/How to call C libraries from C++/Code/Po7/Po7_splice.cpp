@@ -0,0 +1,184 @@
+//
+//  Po7_splice.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_splice.h"
+#include "Po7_ResultGroups.h"
+
+#include <memory>
+
+std::size_t Po7::splice( fd_t in, fd_t out, std::size_t length, splice_flags_t flags )
+   {
+    return Invoke( ssize_t_Result(),
+                   ::splice,
+                   In( in, nullptr, out, nullptr, length, flags ),
+                   ThrowErrorFromErrno() );
+   }
+
+auto Po7::try_splice( fd_t in, fd_t out, std::size_t length, splice_flags_t flags ) -> try_result
+   {
+    return Invoke( ssize_t_TryResult(),
+                   ::splice,
+                   In( in, nullptr, out, nullptr, length, flags ),
+                   ThrowErrorFromErrno() );
+   }
+
+namespace
+   {
+    // One direction of a relay: bytes come in from one socket, wait in the pipe, and go out the other.
+    struct Direction
+       {
+        Po7::socket_t   from;
+        Po7::socket_t   to;
+        Po7::unique_fd  pipeOut;
+        Po7::unique_fd  pipeIn;
+        std::size_t     buffered = 0;
+        bool            ended    = false;       // from's peer has finished sending
+        bool            finished = false;       // and to has been shut down after the last of it
+
+        Direction( Po7::socket_t f, Po7::socket_t t )
+           : from( f ), to( t )
+           {
+            std::tie( pipeOut, pipeIn ) = Po7::pipe( Po7::o_cloexec | Po7::o_nonblock );
+           }
+
+        void Pump();
+       };
+
+    // Pump fills the pipe from one socket and drains it into the other until neither can go further.
+    // Filling stops when the pipe is full as well as when the socket is empty; either way, the drain
+    // that follows, or the next event on the other socket, makes room and calls Pump again.
+    void Direction::Pump()
+       {
+        const std::size_t         most  = std::size_t( 1 ) << 20;     // the pipe itself sets the real limit
+        const Po7::splice_flags_t flags = Po7::splice_f_move | Po7::splice_f_nonblock;
+
+        while ( !finished )
+           {
+            bool moved = false;
+
+            if ( !ended )
+               {
+                Po7::try_result received = Po7::try_splice( from, *pipeIn, most, flags );
+                if ( !received.would_block() )
+                   {
+                    moved = true;
+                    if ( received.size() == 0 )
+                        ended = true;
+                    buffered += received.size();
+                   }
+               }
+
+            if ( buffered != 0 )
+               {
+                Po7::try_result sent = Po7::try_splice( *pipeOut, to, buffered, flags );
+                if ( !sent.would_block() )
+                   {
+                    moved = true;
+                    buffered -= sent.size();
+                   }
+               }
+
+            if ( ended && buffered == 0 )
+               {
+                Po7::shutdown( to, Po7::shut_wr );
+                finished = true;
+               }
+            else if ( !moved )
+                return;
+           }
+       }
+
+    struct Relay
+       {
+        Po7::event_loop&            loop;
+        Direction                   forward;
+        Direction                   backward;
+        Po7::splice_proxy_handler   done;
+        bool                        closed = false;
+
+        Relay( Po7::event_loop& l, Po7::socket_t a, Po7::socket_t b, Po7::splice_proxy_handler d )
+           : loop( l ), forward( a, b ), backward( b, a ), done( std::move( d ) )
+           {}
+
+        void Serve();
+        void Finish( std::error_code );
+       };
+
+    // Either socket's readiness can let either direction move: one is read, the other written.
+    void Relay::Serve()
+       {
+        if ( closed )
+            return;
+
+        try
+           {
+            forward.Pump();
+            backward.Pump();
+           }
+        catch ( const std::system_error& error )
+           {
+            Finish( error.code() );
+            return;
+           }
+
+        if ( forward.finished && backward.finished )
+            Finish( std::error_code() );
+       }
+
+    // The sockets are dropped rather than closed with Po7::close: the relay is over, and there's
+    // nothing more to learn from errors in closing them.
+    void Relay::Finish( std::error_code error )
+       {
+        closed = true;
+        loop.remove( forward.from );
+        loop.remove( forward.to );
+
+        if ( done )
+            done( error );
+       }
+
+    void MakeNonblocking( Po7::socket_t s )
+       {
+        Po7::fcntl_setfl( s, Po7::fcntl_getfl( s ) | Po7::o_nonblock );
+       }
+   }
+
+void Po7::splice_proxy( event_loop& loop, unique_socket a, unique_socket b, splice_proxy_handler done )
+   {
+    MakeNonblocking( *a );
+    MakeNonblocking( *b );
+
+    // The handlers share the relay; it goes when the loop lets go of them both.
+    auto relay = std::make_shared< Relay >( loop, *a, *b, std::move( done ) );
+    auto serve = [relay]( socket_t, epoll_events_t ) { relay->Serve(); };
+
+    const epoll_events_t events = epollin | epollout | epollrdhup;
+
+    loop.add( std::move( a ), events, serve );
+
+    try
+       {
+        loop.add( std::move( b ), events, serve );
+       }
+    catch ( ... )
+       {
+        loop.remove( relay->forward.from );
+        throw;
+       }
+   }
+
+void Po7::splice_proxy( unique_socket a, unique_socket b )
+   {
+    event_loop loop;
+    std::error_code failure;
+
+    splice_proxy( loop, std::move( a ), std::move( b ), [&failure]( std::error_code error ) { failure = error; } );
+    loop.run();
+
+    if ( failure )
+        throw std::system_error( failure );
+   }
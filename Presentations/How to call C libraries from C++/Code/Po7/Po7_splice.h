@@ -0,0 +1,67 @@
+//
+//  Po7_splice.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_SPLICE_H
+#define PO7_SPLICE_H
+
+#include "Po7_event_loop.h"
+#include "Po7_fcntl.h"
+#include "Po7_socket.h"
+#include "Po7_unistd.h"
+
+#include <functional>
+#include <system_error>
+
+#include <fcntl.h>
+
+namespace Po7
+   {
+    // splice isn't POSIX; on Linux it moves data between a pipe and another descriptor inside the kernel.
+    // One end must be a pipe, so moving data from one socket to another takes two splices through a pipe.
+    // The pages are passed along by reference where the kernel can manage it, and never copied to user memory.
+
+    // splice_flags_t is the last parameter to splice()
+        struct SpliceFlagsTag
+           {
+            constexpr unsigned int operator()() const       { return 0; }
+            static const bool hasEquality                   = true;
+            static const bool hasBitwise                    = true;
+           };
+
+        using splice_flags_t = PlusPlus::Boxed< SpliceFlagsTag >;
+
+        const splice_flags_t splice_f_move     = splice_flags_t( SPLICE_F_MOVE );
+        const splice_flags_t splice_f_nonblock = splice_flags_t( SPLICE_F_NONBLOCK );
+        const splice_flags_t splice_f_more     = splice_flags_t( SPLICE_F_MORE );
+
+    // splice moves up to length bytes, and returns how many it moved; zero means the input has ended.
+    // These forms use and advance the descriptors' own offsets, as sockets and pipes have no others.
+        std::size_t splice( fd_t in, fd_t out, std::size_t length, splice_flags_t = splice_flags_t() );
+
+    // try_splice is for non-blocking descriptors.  splice_f_nonblock makes the pipe end non-blocking;
+    // the other end must be non-blocking itself.
+        try_result try_splice( fd_t in, fd_t out, std::size_t length, splice_flags_t = splice_flags_t() );
+
+
+    // splice_proxy relays a pair of connected stream sockets to each other on an event_loop, through a pipe in
+    // each direction, so the relayed bytes stay in the kernel.  When one socket's peer finishes sending, the
+    // other socket is shut down for writing once the pipe has drained, so a half-close passes through.
+    //
+    // The loop takes both sockets, and makes them non-blocking.  When both directions have finished, or either
+    // socket fails, the loop closes both sockets and calls the handler, with the error if there was one.
+    //
+    // splice can't be told MSG_NOSIGNAL, so a write to a socket whose peer has gone raises SIGPIPE.  Programs
+    // that relay should ignore SIGPIPE; then the failure arrives as std::errc::broken_pipe.
+        using splice_proxy_handler = std::function< void ( std::error_code ) >;
+
+        void splice_proxy( event_loop&, unique_socket, unique_socket, splice_proxy_handler = splice_proxy_handler() );
+
+    // This form runs a loop of its own until both directions finish, and throws the error if there is one.
+        void splice_proxy( unique_socket, unique_socket );
+   }
+
+#endif
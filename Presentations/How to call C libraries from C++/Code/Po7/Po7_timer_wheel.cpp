@@ -0,0 +1,312 @@
+//
+//  Po7_timer_wheel.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_timer_wheel.h"
+
+#include <algorithm>
+#include <limits>
+
+const std::uint32_t Po7::timer_wheel::none;
+
+namespace
+   {
+    unsigned LowestBit( std::uint64_t word )
+       {
+        return static_cast< unsigned >( __builtin_ctzll( word ) );
+       }
+   }
+
+Po7::timer_wheel::timer_wheel( handler h, clock::duration r, unsigned k )
+   : onExpiry( std::move( h ) ),
+     resolution( r ),
+     origin( clock::now() ),
+     kinds( k )
+   {
+    if ( resolution <= clock::duration::zero() )
+        throw std::invalid_argument( "A timer wheel's resolution must be positive" );
+    if ( kinds == 0 )
+        throw std::invalid_argument( "A timer wheel needs at least one kind of deadline" );
+
+    heads.fill( none );
+    occupied.fill( 0 );
+   }
+
+std::uint32_t Po7::timer_wheel::IndexFor( socket_t s, timer_kind_t k ) const
+   {
+    int descriptor = Unwrap( s );
+    if ( descriptor < 0 )
+        throw std::invalid_argument( "Can't schedule a deadline for a null socket" );
+    if ( Unwrap( k ) >= kinds )
+        throw std::invalid_argument( "Deadline kind is out of range for this timer wheel" );
+
+    return static_cast< std::uint32_t >( descriptor ) * kinds + Unwrap( k );
+   }
+
+std::uint64_t Po7::timer_wheel::TickAtOrAfter( clock::time_point t ) const
+   {
+    if ( t <= origin )
+        return 0;
+
+    clock::duration elapsed = t - origin;
+    std::uint64_t   ticks   = static_cast< std::uint64_t >( elapsed / resolution );
+    return ticks * resolution < elapsed ? ticks + 1 : ticks;
+   }
+
+std::uint64_t Po7::timer_wheel::TickAtOrBefore( clock::time_point t ) const
+   {
+    if ( t <= origin )
+        return 0;
+
+    return static_cast< std::uint64_t >( ( t - origin ) / resolution );
+   }
+
+void Po7::timer_wheel::Link( std::uint32_t index, std::uint32_t bucket )
+   {
+    node& n = nodes[ index ];
+    n.bucket   = bucket;
+    n.previous = none;
+    n.next     = heads[ bucket ];
+
+    if ( n.next != none )
+        nodes[ n.next ].previous = index;
+    heads[ bucket ] = index;
+
+    if ( bucket != expiringBucket )
+        occupied[ bucket / 64 ] |= std::uint64_t( 1 ) << ( bucket % 64 );
+   }
+
+void Po7::timer_wheel::Unlink( std::uint32_t index )
+   {
+    node& n = nodes[ index ];
+
+    if ( n.previous != none )
+        nodes[ n.previous ].next = n.next;
+    else
+        heads[ n.bucket ] = n.next;
+
+    if ( n.next != none )
+        nodes[ n.next ].previous = n.previous;
+
+    if ( heads[ n.bucket ] == none && n.bucket != expiringBucket )
+        occupied[ n.bucket / 64 ] &= ~( std::uint64_t( 1 ) << ( n.bucket % 64 ) );
+
+    n.bucket   = none;
+    n.previous = none;
+    n.next     = none;
+   }
+
+void Po7::timer_wheel::Place( std::uint32_t index )
+   {
+    // A deadline goes in the finest level whose slots, counted from the current one, reach it.
+    // Those beyond the top level wait in its farthest slot, and are placed again when it comes around.
+
+    const std::uint64_t expiry = std::max( nodes[ index ].expiry, current );
+
+    for ( unsigned level = 0; level < levels; ++level )
+       {
+        const unsigned shift = level * slotBits;
+
+        if ( ( expiry >> shift ) - ( current >> shift ) < slots )
+           {
+            Link( index, level * slots + unsigned( ( expiry >> shift ) % slots ) );
+            return;
+           }
+       }
+
+    const unsigned shift = ( levels - 1 ) * slotBits;
+    Link( index, ( levels - 1 ) * slots + unsigned( ( ( current >> shift ) + slots - 1 ) % slots ) );
+   }
+
+void Po7::timer_wheel::Cascade( unsigned level, unsigned slot )
+   {
+    const std::uint32_t bucket = level * slots + slot;
+
+    while ( heads[ bucket ] != none )
+       {
+        std::uint32_t index = heads[ bucket ];
+        Unlink( index );
+        Place( index );
+       }
+   }
+
+std::size_t Po7::timer_wheel::FireExpiring()
+   {
+    std::size_t called = 0;
+
+    // Handlers may cancel or reschedule anything, so take one deadline at a time.
+    while ( heads[ expiringBucket ] != none )
+       {
+        std::uint32_t index = heads[ expiringBucket ];
+        Unlink( index );
+        --scheduledCount;
+        ++called;
+
+        onExpiry( Wrap< socket_t >( int( index / kinds ) ), timer_kind_t( index % kinds ) );
+       }
+
+    return called;
+   }
+
+unsigned Po7::timer_wheel::OccupiedDistance( unsigned level, unsigned from ) const
+   {
+    // How many slots past from the first non-empty slot of the level is, counting around; slots if none is.
+
+    const unsigned firstWord = level * slots / 64;
+    const unsigned words     = slots / 64;
+    const unsigned word      = from / 64;
+    const unsigned bit       = from % 64;
+
+    std::uint64_t bits = occupied[ firstWord + word ] & ( ~std::uint64_t( 0 ) << bit );
+    if ( bits != 0 )
+        return word * 64 + LowestBit( bits ) - from;
+
+    for ( unsigned i = 1; i < words; ++i )
+       {
+        unsigned w = ( word + i ) % words;
+        if ( occupied[ firstWord + w ] != 0 )
+            return ( w * 64 + LowestBit( occupied[ firstWord + w ] ) + slots - from ) % slots;
+       }
+
+    bits = occupied[ firstWord + word ] & ( ( std::uint64_t( 1 ) << bit ) - 1 );
+    if ( bits != 0 )
+        return word * 64 + LowestBit( bits ) + slots - from;
+
+    return slots;
+   }
+
+bool Po7::timer_wheel::NextWork( std::uint64_t& tick ) const
+   {
+    // The next tick at which a deadline expires or a slot cascades; the wheel needn't be looked at before then.
+
+    if ( heads[ expiringBucket ] != none )
+       {
+        tick = current;
+        return true;
+       }
+
+    if ( scheduledCount == 0 )
+        return false;
+
+    std::uint64_t earliest = std::numeric_limits< std::uint64_t >::max();
+
+    for ( unsigned level = 0; level < levels; ++level )
+       {
+        const unsigned      shift    = level * slotBits;
+        const std::uint64_t base     = current >> shift;
+        const unsigned      distance = OccupiedDistance( level, unsigned( base % slots ) );
+
+        if ( distance < slots )
+            earliest = std::min( earliest, std::max( current, ( base + distance ) << shift ) );
+       }
+
+    tick = earliest;
+    return earliest != std::numeric_limits< std::uint64_t >::max();
+   }
+
+void Po7::timer_wheel::schedule( socket_t s, timer_kind_t k, clock::time_point deadline )
+   {
+    std::uint32_t index = IndexFor( s, k );
+
+    if ( index >= nodes.size() )
+        nodes.resize( ( index / kinds + 1 ) * kinds );
+
+    if ( nodes[ index ].bucket != none )
+        Unlink( index );
+    else
+        ++scheduledCount;
+
+    nodes[ index ].expiry = TickAtOrAfter( deadline );
+    Place( index );
+   }
+
+bool Po7::timer_wheel::cancel( socket_t s, timer_kind_t k )
+   {
+    std::uint32_t index = IndexFor( s, k );
+
+    if ( index >= nodes.size() || nodes[ index ].bucket == none )
+        return false;
+
+    Unlink( index );
+    --scheduledCount;
+    return true;
+   }
+
+void Po7::timer_wheel::cancel( socket_t s )
+   {
+    for ( unsigned k = 0; k < kinds; ++k )
+        cancel( s, timer_kind_t( k ) );
+   }
+
+bool Po7::timer_wheel::scheduled( socket_t s, timer_kind_t k ) const
+   {
+    std::uint32_t index = IndexFor( s, k );
+    return index < nodes.size() && nodes[ index ].bucket != none;
+   }
+
+std::chrono::milliseconds Po7::timer_wheel::next_timeout( clock::time_point now ) const
+   {
+    std::uint64_t tick;
+    if ( !NextWork( tick ) )
+        return std::chrono::milliseconds( -1 );
+
+    clock::time_point due = origin + clock::duration( resolution * tick );
+    if ( due <= now )
+        return std::chrono::milliseconds( 0 );
+
+    // Round up, so the loop doesn't wake just before the tick and spin.  Past what epoll_wait can take,
+    // waking early is harmless: the loop just asks again.
+    const std::chrono::milliseconds longest( std::numeric_limits< int >::max() );
+
+    clock::duration remaining = due - now;
+    if ( remaining >= longest )
+        return longest;
+
+    std::chrono::milliseconds timeout = std::chrono::duration_cast< std::chrono::milliseconds >( remaining );
+    if ( timeout < remaining )
+        ++timeout;
+
+    return timeout;
+   }
+
+std::size_t Po7::timer_wheel::expire( clock::time_point now )
+   {
+    const std::uint64_t target = TickAtOrBefore( now );
+
+    std::size_t called = FireExpiring();
+
+    // Skip straight to each tick with work to do, so a quiet wheel costs nothing however long it slept.
+    std::uint64_t tick;
+    while ( NextWork( tick ) && tick <= target )
+       {
+        current = tick;
+
+        for ( unsigned level = 1; level < levels; ++level )
+           {
+            const unsigned shift = level * slotBits;
+            if ( current % ( std::uint64_t( 1 ) << shift ) != 0 )
+                break;
+            Cascade( level, unsigned( ( current >> shift ) % slots ) );
+           }
+
+        // Move the slot's deadlines aside first, so handlers scheduling a tick ahead don't land among them.
+        const std::uint32_t bucket = unsigned( current % slots );
+        while ( heads[ bucket ] != none )
+           {
+            std::uint32_t index = heads[ bucket ];
+            Unlink( index );
+            Link( index, expiringBucket );
+           }
+
+        ++current;
+        called += FireExpiring();
+       }
+
+    if ( current <= target )
+        current = target + 1;
+
+    return called;
+   }
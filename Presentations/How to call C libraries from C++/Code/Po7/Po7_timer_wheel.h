@@ -0,0 +1,143 @@
+//
+//  Po7_timer_wheel.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_TIMER_WHEEL_H
+#define PO7_TIMER_WHEEL_H
+
+#include "Po7_socket.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+namespace Po7
+   {
+    // timer_kind_t tells apart the deadlines a socket can have at once.
+        struct TimerKindTag
+           {
+            constexpr unsigned operator()() const           { return 0; }
+            static const bool hasEquality                   = true;
+            static const bool hasComparison                 = true;
+           };
+
+        using timer_kind_t = PlusPlus::Boxed< TimerKindTag >;
+
+        const timer_kind_t read_deadline      = timer_kind_t( 0 );
+        const timer_kind_t write_deadline     = timer_kind_t( 1 );
+        const timer_kind_t keepalive_deadline = timer_kind_t( 2 );
+
+
+    // timer_wheel keeps deadlines for sockets: each socket can have one deadline of each kind, and when a
+    // deadline passes the wheel calls its handler with the socket and the kind.  Scheduling, rescheduling, and
+    // cancelling take constant time, however many deadlines are pending.
+    //
+    // The deadlines sit in a hierarchical timing wheel.  There are four levels of 256 slots.  Each slot in the
+    // first level is one tick wide, and each slot in a higher level is 256 times as wide as a slot in the level
+    // below.  As time reaches a slot in a higher level, its deadlines move down to finer slots.  With the
+    // default one-millisecond tick, the wheel spans about 49 days; later deadlines wait at the top until they
+    // come within range.
+    //
+    // Like event_loop, the wheel keeps its deadlines in a table indexed by descriptor, linked by index.  The
+    // table grows when a deadline is first scheduled for a larger descriptor.  After that, scheduling and
+    // cancelling never touch the heap.  One handler serves the whole wheel, so there is no std::function per
+    // deadline either.
+    //
+    // The wheel reads time from steady_clock but never waits.  It works with any loop that can wait with a
+    // timeout:
+    //
+    //     loop.run_once( wheel.next_timeout() );
+    //     wheel.expire();
+    //
+    // Deadlines are rounded up to the next tick, so a handler is never called early.
+        class timer_wheel
+           {
+            public:
+                using clock   = std::chrono::steady_clock;
+                using handler = std::function< void ( socket_t, timer_kind_t ) >;
+
+            private:
+                static const unsigned       slotBits = 8;
+                static const unsigned       slots    = 1u << slotBits;
+                static const unsigned       levels   = 4;
+                static const std::uint32_t  none     = 0xFFFFFFFFu;
+
+                static const std::uint32_t  expiringBucket = levels * slots;    // deadlines being handled
+
+                struct node
+                   {
+                    std::uint64_t  expiry = 0;                  // in ticks since origin
+                    std::uint32_t  previous = none;
+                    std::uint32_t  next = none;
+                    std::uint32_t  bucket = none;               // none when not scheduled
+                   };
+
+                handler                                         onExpiry;
+                clock::duration                                 resolution;
+                clock::time_point                               origin;
+                unsigned                                        kinds;
+
+                std::vector< node >                             nodes;          // indexed by descriptor * kinds + kind
+                std::array< std::uint32_t, levels * slots + 1 > heads;
+                std::array< std::uint64_t, levels * slots / 64 > occupied;      // a bit per non-empty slot
+                std::uint64_t                                   current = 0;    // the next tick to process
+                std::size_t                                     scheduledCount = 0;
+
+                std::uint32_t IndexFor( socket_t, timer_kind_t ) const;
+                std::uint64_t TickAtOrAfter( clock::time_point ) const;
+                std::uint64_t TickAtOrBefore( clock::time_point ) const;
+
+                void Link( std::uint32_t index, std::uint32_t bucket );
+                void Unlink( std::uint32_t index );
+                void Place( std::uint32_t index );
+                void Cascade( unsigned level, unsigned slot );
+                std::size_t FireExpiring();
+                bool NextWork( std::uint64_t& tick ) const;
+                unsigned OccupiedDistance( unsigned level, unsigned from ) const;
+
+            public:
+            // Deadlines are tracked to the resolution; kinds is the number of deadlines each socket may have.
+                explicit timer_wheel( handler,
+                                      clock::duration resolution = std::chrono::milliseconds( 1 ),
+                                      unsigned kinds = 3 );
+
+                timer_wheel( const timer_wheel& )               = delete;
+                timer_wheel& operator=( const timer_wheel& )    = delete;
+
+            // schedule sets the socket's deadline of that kind, replacing any deadline it had.
+                void schedule( socket_t, timer_kind_t, clock::time_point deadline );
+
+                void schedule( socket_t s, timer_kind_t k, clock::duration timeout )
+                   {
+                    schedule( s, k, clock::now() + timeout );
+                   }
+
+            // cancel removes a deadline, returning whether there was one; the one-argument form removes all of
+            // the socket's deadlines.  Cancel a socket's deadlines before closing it, or its descriptor's next
+            // owner inherits them.
+                bool cancel( socket_t, timer_kind_t );
+                void cancel( socket_t );
+
+                bool scheduled( socket_t, timer_kind_t ) const;
+                std::size_t size() const                        { return scheduledCount; }
+
+            // next_timeout is how long a loop may wait before calling expire: -1 when nothing is scheduled, as
+            // run_once and epoll_wait expect.  It may be shorter than the time to the next deadline, when
+            // deadlines need to move down a level first, or when the deadline is further off than an int
+            // number of milliseconds.
+                std::chrono::milliseconds next_timeout( clock::time_point now = clock::now() ) const;
+
+            // expire calls the handlers of the deadlines that have passed, and returns how many it called.
+            // Handlers may schedule and cancel deadlines, but shouldn't call expire.  If a handler throws, the
+            // other deadlines that have passed stay due until the next call.
+                std::size_t expire( clock::time_point now = clock::now() );
+           };
+   }
+
+#endif
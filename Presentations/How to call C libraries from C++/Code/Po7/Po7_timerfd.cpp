@@ -0,0 +1,143 @@
+//
+//  Po7_timerfd.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_timerfd.h"
+#include "Po7_ResultGroups.h"
+
+#include <algorithm>
+#include <cstring>
+
+void Po7::TimerFDDeleter::operator()( pointer p ) const
+   {
+    // Don't use Invoke in the deleter; this must ignore errors
+
+    int descriptor = Unwrap( *p );
+
+    if ( descriptor != -1 )
+        ::close( descriptor );
+   }
+
+auto Po7::MakeAnything( ThingToMake< timespec >, std::chrono::nanoseconds n ) -> timespec
+   {
+    auto seconds = std::chrono::duration_cast< std::chrono::seconds >( n );
+    if ( seconds > n )
+        seconds -= std::chrono::seconds( 1 );       // timespec keeps its nanoseconds non-negative
+
+    timespec result;
+    std::memset( &result, 0, sizeof( result ) );
+
+    result.tv_sec  = static_cast< ::time_t >( seconds.count() );
+    result.tv_nsec = static_cast< long >( ( n - seconds ).count() );
+
+    return result;
+   }
+
+auto Po7::MakeAnything( ThingToMake< itimerspec >, std::chrono::nanoseconds initial, std::chrono::nanoseconds interval ) -> itimerspec
+   {
+    itimerspec result;
+    std::memset( &result, 0, sizeof( result ) );
+
+    result.it_value    = Make< timespec >( initial );
+    result.it_interval = Make< timespec >( interval );
+
+    return result;
+   }
+
+auto Po7::MakeAnything( ThingToMake< std::chrono::nanoseconds >, const timespec& t ) -> std::chrono::nanoseconds
+   {
+    return std::chrono::seconds( t.tv_sec ) + std::chrono::nanoseconds( t.tv_nsec );
+   }
+
+auto Po7::timerfd_create( clock_id_t clock, timerfd_flags_t flags ) -> unique_timerfd
+   {
+    return Invoke( Result< unique_timerfd >() + FailsWhenFalse(),
+                   ::timerfd_create,
+                   In( clock, flags ),
+                   ThrowErrorFromErrno() );
+   }
+
+void Po7::close( unique_timerfd t )
+   {
+    return Invoke( FailureFlagResult<int>(),
+                   ::close,
+                   In( std::move( t ) ),
+                   ThrowErrorFromErrno() );
+   }
+
+auto Po7::timerfd_settime( timerfd_t t, timerfd_settime_flags_t flags, const itimerspec& value ) -> itimerspec
+   {
+    itimerspec previous;
+
+    Invoke( FailureFlagResult<int>(),
+            ::timerfd_settime,
+            In( t, flags, value ),
+            InOut( previous ),
+            ThrowErrorFromErrno() );
+
+    return previous;
+   }
+
+auto Po7::timerfd_gettime( timerfd_t t ) -> itimerspec
+   {
+    itimerspec current;
+
+    Invoke( FailureFlagResult<int>(),
+            ::timerfd_gettime,
+            In( t ),
+            InOut( current ),
+            ThrowErrorFromErrno() );
+
+    return current;
+   }
+
+void Po7::timerfd_arm( timerfd_t t, std::chrono::nanoseconds delay, std::chrono::nanoseconds interval )
+   {
+    delay = std::max( delay, std::chrono::nanoseconds( 1 ) );
+    timerfd_settime( t, timerfd_settime_flags_t(), Make< itimerspec >( delay, interval ) );
+   }
+
+void Po7::timerfd_arm( timerfd_t t, std::chrono::steady_clock::time_point expiration, std::chrono::nanoseconds interval )
+   {
+    // An absolute expiration in the past fires at once, so only zero itself needs adjusting.
+    auto since = std::chrono::duration_cast< std::chrono::nanoseconds >( expiration.time_since_epoch() );
+    since = std::max( since, std::chrono::nanoseconds( 1 ) );
+    timerfd_settime( t, tfd_timer_abstime, Make< itimerspec >( since, interval ) );
+   }
+
+void Po7::timerfd_disarm( timerfd_t t )
+   {
+    timerfd_settime( t, timerfd_settime_flags_t(), Make< itimerspec >( std::chrono::nanoseconds( 0 ) ) );
+   }
+
+std::uint64_t Po7::timerfd_read( timerfd_t t )
+   {
+    std::uint64_t expirations = 0;
+
+    Invoke( ssize_t_FlagResult(),
+            ::read,
+            In( t ),
+            InOut( expirations ),
+            In( sizeof( expirations ) ),
+            ThrowErrorFromErrno() );
+
+    return expirations;
+   }
+
+std::uint64_t Po7::try_timerfd_read( timerfd_t t )
+   {
+    // A read that would block leaves the count at zero.
+    std::uint64_t expirations = 0;
+
+    Invoke( ssize_t_TryFlagResult(),
+            ::read,
+            In( t ),
+            InOut( expirations ),
+            In( sizeof( expirations ) ),
+            ThrowErrorFromErrno() );
+
+    return expirations;
+   }
@@ -0,0 +1,122 @@
+//
+//  Po7_timerfd.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_TIMERFD_H
+#define PO7_TIMERFD_H
+
+#include "Po7_Basics.h"
+#include "Po7_unistd.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include <sys/timerfd.h>
+#include <time.h>
+
+namespace Po7
+   {
+    // A timerfd is a timer with a descriptor.  It becomes readable when the timer expires, and reading it
+    // returns the number of expirations since the last read, so an epoll instance can wait for timers along
+    // with its sockets.
+
+    // timerfd_t represents a timerfd
+        struct TimerFDTag
+           {
+            constexpr int operator()() const            { return -1; }
+            static const bool hasEquality               = true;
+            static const bool hasComparison             = true;
+            constexpr operator FileDescriptorTag() const { return FileDescriptorTag(); }
+           };
+
+        using timerfd_t = PlusPlus::Boxed< TimerFDTag >;
+
+    // unique_timerfd refers to a timerfd, and represents the obligation to close it
+        struct TimerFDDeleter
+           {
+            using pointer = PlusPlus::PointerToValue< timerfd_t >;
+            void operator()( pointer t ) const;
+            operator FileDescriptorDeleter() const  { return FileDescriptorDeleter(); }
+           };
+
+        using unique_timerfd = std::unique_ptr< const timerfd_t, TimerFDDeleter >;
+
+
+    // clock_id_t names the clock a timer follows.  clock_monotonic is the clock behind std::chrono::steady_clock.
+        enum class clock_id_t: ::clockid_t {};
+        template <> struct Wrapper< clock_id_t >: PlusPlus::EnumWrapper< clock_id_t > {};
+
+        const clock_id_t clock_realtime  = clock_id_t( CLOCK_REALTIME );
+        const clock_id_t clock_monotonic = clock_id_t( CLOCK_MONOTONIC );
+        #ifdef CLOCK_BOOTTIME
+            const clock_id_t clock_boottime = clock_id_t( CLOCK_BOOTTIME );
+        #endif
+
+    // timerfd_flags_t is the second parameter to timerfd_create()
+        struct TimerFDFlagsTag
+           {
+            constexpr int operator()() const                { return 0; }
+            static const bool hasEquality                   = true;
+            static const bool hasBitwise                    = true;
+           };
+
+        using timerfd_flags_t = PlusPlus::Boxed< TimerFDFlagsTag >;
+
+        const timerfd_flags_t tfd_cloexec  = timerfd_flags_t( TFD_CLOEXEC );
+        const timerfd_flags_t tfd_nonblock = timerfd_flags_t( TFD_NONBLOCK );
+
+    // timerfd_settime_flags_t is the second parameter to timerfd_settime()
+        struct TimerFDSettimeFlagsTag
+           {
+            constexpr int operator()() const                { return 0; }
+            static const bool hasEquality                   = true;
+            static const bool hasBitwise                    = true;
+           };
+
+        using timerfd_settime_flags_t = PlusPlus::Boxed< TimerFDSettimeFlagsTag >;
+
+        const timerfd_settime_flags_t tfd_timer_abstime = timerfd_settime_flags_t( TFD_TIMER_ABSTIME );
+
+
+    // timespec and itimerspec are made from std::chrono durations.  An itimerspec holds the first expiration
+    // and the interval between later ones; an interval of zero makes the timer fire once.
+        using ::timespec;
+        using ::itimerspec;
+
+        timespec MakeAnything( ThingToMake< timespec >, std::chrono::nanoseconds );
+        itimerspec MakeAnything( ThingToMake< itimerspec >, std::chrono::nanoseconds initial,
+                                                            std::chrono::nanoseconds interval = std::chrono::nanoseconds( 0 ) );
+
+        std::chrono::nanoseconds MakeAnything( ThingToMake< std::chrono::nanoseconds >, const timespec& );
+
+
+    // timerfd_create() creates timerfds, and close() gets rid of them.
+        unique_timerfd timerfd_create( clock_id_t, timerfd_flags_t = timerfd_flags_t() );
+
+        void close( unique_timerfd );
+
+    // timerfd_settime arms or disarms the timer, returning the setting it replaces.  An itimerspec whose
+    // first expiration is zero disarms it.  timerfd_gettime returns the time left and the interval.
+        itimerspec timerfd_settime( timerfd_t, timerfd_settime_flags_t, const itimerspec& );
+        itimerspec timerfd_gettime( timerfd_t );
+
+    // timerfd_arm and timerfd_disarm are the common cases.  A delay of zero would disarm the timer, so
+    // timerfd_arm makes it a nanosecond.  The time_point form sets an absolute expiration, and is for
+    // timers on clock_monotonic.
+        void timerfd_arm( timerfd_t, std::chrono::nanoseconds delay,
+                                     std::chrono::nanoseconds interval = std::chrono::nanoseconds( 0 ) );
+        void timerfd_arm( timerfd_t, std::chrono::steady_clock::time_point expiration,
+                                     std::chrono::nanoseconds interval = std::chrono::nanoseconds( 0 ) );
+        void timerfd_disarm( timerfd_t );
+
+    // timerfd_read waits for the timer to expire, and returns the number of expirations since the last read.
+    // try_timerfd_read is for tfd_nonblock timerfds; it returns zero if the timer hasn't expired.
+        std::uint64_t timerfd_read( timerfd_t );
+        std::uint64_t try_timerfd_read( timerfd_t );
+   }
+
+#endif
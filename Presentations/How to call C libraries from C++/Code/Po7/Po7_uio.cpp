@@ -0,0 +1,52 @@
+//
+//  Po7_uio.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_uio.h"
+#include "Po7_ResultGroups.h"
+
+namespace
+   {
+    int VectorCount( std::size_t count )
+       {
+        if ( count > Po7::iov_max )
+            throw std::length_error( "Too many buffers for one scatter/gather call" );
+
+        return static_cast< int >( count );
+       }
+   }
+
+std::size_t Po7::readv( fd_t d, const iovec *vectors, std::size_t count )
+   {
+    return Invoke( ssize_t_Result(),
+                   ::readv,
+                   In( d, vectors, VectorCount( count ) ),
+                   ThrowErrorFromErrno() );
+   }
+
+std::size_t Po7::writev( fd_t d, const iovec *vectors, std::size_t count )
+   {
+    return Invoke( ssize_t_Result(),
+                   ::writev,
+                   In( d, vectors, VectorCount( count ) ),
+                   ThrowErrorFromErrno() );
+   }
+
+std::size_t Po7::preadv( fd_t d, const iovec *vectors, std::size_t count, ::off_t offset )
+   {
+    return Invoke( ssize_t_Result(),
+                   ::preadv,
+                   In( d, vectors, VectorCount( count ), offset ),
+                   ThrowErrorFromErrno() );
+   }
+
+std::size_t Po7::pwritev( fd_t d, const iovec *vectors, std::size_t count, ::off_t offset )
+   {
+    return Invoke( ssize_t_Result(),
+                   ::pwritev,
+                   In( d, vectors, VectorCount( count ), offset ),
+                   ThrowErrorFromErrno() );
+   }
@@ -0,0 +1,122 @@
+//
+//  Po7_uio.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_UIO_H
+#define PO7_UIO_H
+
+#include "Po7_Basics.h"
+#include "Po7_unistd.h"
+
+#include "bufferlike.h"
+
+#include <climits>
+#include <stdexcept>
+
+#include <sys/uio.h>
+
+namespace Po7
+   {
+    // iovec is a structure type describing one buffer of a scatter/gather operation
+        using ::iovec;
+
+    // iov_max is the most buffers a single scatter/gather call will take.
+        #ifdef IOV_MAX
+            const std::size_t iov_max = IOV_MAX;
+        #else
+            const std::size_t iov_max = _XOPEN_IOV_MAX;
+        #endif
+
+    // iovec_array describes a sequence of buffers (see PlusPlus/bufferlike.h) as iovecs, without allocating.
+    // A sequence of fixed size gets exactly as many iovecs as it has buffers; a sequence sized at run time
+    // gets room for iov_max of them.  Either way, the iovecs are kept within the iovec_array, usually on the stack.
+    //
+    // The iovec_array refers to the buffers; it must not outlive them.
+        template < class Sequence >
+        class iovec_array
+           {
+            private:
+                static const std::size_t extent   = PlusPlus::stdish::buffer_sequence_extent< typename std::remove_const<Sequence>::type >::value;
+                static const std::size_t capacity = extent != 0 ? extent : iov_max;
+
+                iovec       vectors[ capacity ];
+                std::size_t count;
+
+                struct Filler
+                   {
+                    iovec *next;
+
+                    void operator()( const void *data, std::size_t size )
+                       {
+                        next->iov_base = const_cast< void * >( data );
+                        next->iov_len  = size;
+                        ++next;
+                       }
+                   };
+
+            public:
+                explicit iovec_array( Sequence& buffers )
+                   : count( PlusPlus::stdish::buffer_sequence_size( buffers ) )
+                   {
+                    if ( count > capacity )
+                        throw std::length_error( "Too many buffers for one scatter/gather call" );
+
+                    Filler filler = { vectors };
+                    PlusPlus::stdish::for_each_buffer( buffers, filler );
+                   }
+
+                iovec_array( const iovec_array& )               = delete;
+                iovec_array& operator=( const iovec_array& )    = delete;
+
+                iovec       *data()                             { return vectors; }
+                const iovec *data() const                       { return vectors; }
+                std::size_t  size() const                       { return count; }
+           };
+
+
+    // readv and writev gather into and scatter from several buffers in one call, at the descriptor's own
+    // offset; preadv and pwritev take an offset instead, as pread and pwrite do.  Like read and write,
+    // each makes one call, which may transfer less than the buffers hold.
+        std::size_t readv(   fd_t, const iovec *vectors, std::size_t count );
+        std::size_t writev(  fd_t, const iovec *vectors, std::size_t count );
+        std::size_t preadv(  fd_t, const iovec *vectors, std::size_t count, ::off_t offset );
+        std::size_t pwritev( fd_t, const iovec *vectors, std::size_t count, ::off_t offset );
+
+    // They also take sequences of buffers, as sendmsg and recvmsg do.
+        template < class Sequence >
+        auto readv( fd_t d, Sequence& buffers )
+        -> typename std::enable_if< PlusPlus::stdish::is_buffer_sequence<Sequence>::value, std::size_t >::type
+           {
+            iovec_array< Sequence > vectors( buffers );
+            return readv( d, vectors.data(), vectors.size() );
+           }
+
+        template < class Sequence >
+        auto writev( fd_t d, const Sequence& buffers )
+        -> typename std::enable_if< PlusPlus::stdish::is_buffer_sequence<Sequence>::value, std::size_t >::type
+           {
+            iovec_array< const Sequence > vectors( buffers );
+            return writev( d, vectors.data(), vectors.size() );
+           }
+
+        template < class Sequence >
+        auto preadv( fd_t d, Sequence& buffers, ::off_t offset )
+        -> typename std::enable_if< PlusPlus::stdish::is_buffer_sequence<Sequence>::value, std::size_t >::type
+           {
+            iovec_array< Sequence > vectors( buffers );
+            return preadv( d, vectors.data(), vectors.size(), offset );
+           }
+
+        template < class Sequence >
+        auto pwritev( fd_t d, const Sequence& buffers, ::off_t offset )
+        -> typename std::enable_if< PlusPlus::stdish::is_buffer_sequence<Sequence>::value, std::size_t >::type
+           {
+            iovec_array< const Sequence > vectors( buffers );
+            return pwritev( d, vectors.data(), vectors.size(), offset );
+           }
+   }
+
+#endif
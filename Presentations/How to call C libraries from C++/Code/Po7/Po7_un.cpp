@@ -0,0 +1,180 @@
+//
+//  Po7_un.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_un.h"
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+   {
+    const std::size_t pathOffset = offsetof( sockaddr_un, sun_path );
+    const std::size_t pathSpace  = sizeof( sockaddr_un ) - offsetof( sockaddr_un, sun_path );
+
+    union FileDescriptorControl
+       {
+        char    bytes[ CMSG_SPACE( sizeof( int ) * Po7::max_fds_per_message ) ];
+        cmsghdr alignment;
+       };
+   }
+
+// sockaddr_un
+
+sockaddr_un Po7::MakeAnything( ThingToMake< sockaddr_un >, const std::string& text )
+   {
+    sockaddr_un result;
+    std::memset( &result, 0, sizeof( result ) );
+
+    result.sun_family = AF_UNIX;
+
+    if ( text.empty() )
+        return result;
+
+    const bool abstract = text[0] == '@' || text[0] == '\0';
+
+    // A path needs room for its terminating NUL; an abstract name replaces its '@' with the leading NUL.
+    if ( text.size() + ( abstract ? 0 : 1 ) > pathSpace )
+        throw std::length_error( "Unix-domain socket address too long" );
+
+    std::memcpy( result.sun_path, text.data(), text.size() );
+
+    if ( abstract )
+        result.sun_path[0] = '\0';
+
+    return result;
+   }
+
+std::string Po7::MakeAnything( ThingToMake< std::string >, const sockaddr_un& address )
+   {
+    const std::size_t length = sockaddr_length( address ) - pathOffset;
+
+    if ( length == 0 )
+        return std::string();
+
+    if ( is_abstract( address ) )
+        return "@" + std::string( address.sun_path + 1, length - 1 );
+
+    // A path that fills sun_path has no terminating NUL to leave off.
+    const bool terminated = address.sun_path[ length - 1 ] == '\0';
+    return std::string( address.sun_path, terminated ? length - 1 : length );
+   }
+
+bool Po7::is_abstract( const sockaddr_un& address )
+   {
+    return address.sun_path[0] == '\0' && sockaddr_length( address ) > pathOffset;
+   }
+
+socklen_t Po7::sockaddr_length_trait< sockaddr_un >::length( const sockaddr_un& address )
+   {
+    const char *path = address.sun_path;
+
+    if ( path[0] != '\0' )
+       {
+        const char *end = std::find( path, path + pathSpace, '\0' );
+        return socklen_t( pathOffset + ( end - path ) + ( end == path + pathSpace ? 0 : 1 ) );
+       }
+
+    std::size_t used = pathSpace;
+    while ( used > 1 && path[ used - 1 ] == '\0' )
+        --used;
+
+    if ( used == 1 )
+        return socklen_t( pathOffset );         // unnamed
+
+    return socklen_t( pathOffset + used );
+   }
+
+
+
+// descriptor passing
+
+std::size_t Po7::send_fds( socket_t socket, const void *buffer, std::size_t length, const fd_t *fds, std::size_t count, msg_flags_t flags )
+   {
+    if ( count > max_fds_per_message )
+        throw std::length_error( "Too many descriptors for one message" );
+
+    iovec vector;
+    vector.iov_base = const_cast< void * >( buffer );
+    vector.iov_len  = length;
+
+    msghdr message = Make< msghdr >( &vector, 1 );
+
+    FileDescriptorControl control;
+
+    if ( count != 0 )
+       {
+        std::memset( control.bytes, 0, sizeof( control.bytes ) );
+        message.msg_control    = control.bytes;
+        message.msg_controllen = CMSG_SPACE( sizeof( int ) * count );
+
+        cmsghdr *header = CMSG_FIRSTHDR( &message );
+        header->cmsg_level = SOL_SOCKET;
+        header->cmsg_type  = SCM_RIGHTS;
+        header->cmsg_len   = CMSG_LEN( sizeof( int ) * count );
+
+        unsigned char *data = CMSG_DATA( header );
+        for ( std::size_t i = 0; i < count; ++i )
+           {
+            const int fd = Unwrap( fds[i] );
+            std::memcpy( data + i * sizeof( int ), &fd, sizeof( int ) );
+           }
+       }
+
+    return sendmsg( socket, message, flags );
+   }
+
+std::size_t Po7::recv_fds( socket_t socket, void *buffer, std::size_t length, fd_t *fds, std::size_t& count, bool& truncated, msg_flags_t flags )
+   {
+    const std::size_t room = std::min( count, max_fds_per_message );
+    count = 0;
+    truncated = false;
+
+    iovec vector;
+    vector.iov_base = buffer;
+    vector.iov_len  = length;
+
+    msghdr message = Make< msghdr >( &vector, 1 );
+
+    FileDescriptorControl control;
+
+    if ( room != 0 )
+       {
+        message.msg_control    = control.bytes;
+        message.msg_controllen = CMSG_SPACE( sizeof( int ) * room );
+       }
+
+    std::size_t received = recvmsg( socket, message, flags | msg_cmsg_cloexec );
+
+    for ( cmsghdr *header = CMSG_FIRSTHDR( &message ); header != nullptr; header = CMSG_NXTHDR( &message, header ) )
+       {
+        if ( header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS )
+            continue;
+
+        const unsigned char *data = CMSG_DATA( header );
+        const std::size_t arrived = ( header->cmsg_len - CMSG_LEN( 0 ) ) / sizeof( int );
+
+        for ( std::size_t i = 0; i < arrived; ++i )
+           {
+            int fd;
+            std::memcpy( &fd, data + i * sizeof( int ), sizeof( int ) );
+
+            if ( count < room )
+                fds[ count++ ] = Wrap< fd_t >( fd );
+            else
+               {
+                ::close( fd );
+                truncated = true;
+               }
+           }
+       }
+
+    if ( ( message.msg_flags & MSG_CTRUNC ) != 0 )
+        truncated = true;
+
+    return received;
+   }
@@ -0,0 +1,106 @@
+//
+//  Po7_un.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_UN_H
+#define PO7_UN_H
+
+#include "Po7_Basics.h"
+#include "Po7_is_sockaddr.h"
+#include "Po7_socket.h"
+#include "Po7_unistd.h"
+
+#include "bufferlike.h"
+
+#include <algorithm>
+#include <initializer_list>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <sys/un.h>
+
+namespace Po7
+   {
+    // sockaddr_un
+        using ::sockaddr_un;
+        template <> struct is_sockaddr< sockaddr_un >:          std::true_type {};
+        template <> struct sockaddr_domain< sockaddr_un >:      std::integral_constant< socket_domain_t, af_unix > {};
+        template <> struct sockaddr_type_trait< af_unix >       { using type = sockaddr_un; };
+
+    // A Unix-domain address is a path, or on Linux, a name in the abstract namespace, which has no file and
+    // disappears when its last socket closes.  As strings, abstract names are written with a leading '@'
+    // (or the leading NUL the kernel uses); to name a file that starts with '@', write "./@...".
+    // An empty string is the unnamed address that a socket gets when it isn't bound.
+    //
+    // Abstract names may contain NULs, but can't end with one: the length passed to the kernel
+    // stops at the last non-NUL character.
+        sockaddr_un MakeAnything( ThingToMake< sockaddr_un >, const std::string& );
+        std::string MakeAnything( ThingToMake< std::string >, const sockaddr_un& );
+
+        bool is_abstract( const sockaddr_un& );
+
+        template <>
+        struct sockaddr_length_trait< sockaddr_un >
+           {
+            static socklen_t length( const sockaddr_un& );
+           };
+
+
+    // send_fds and recv_fds pass descriptors between processes over a Unix-domain socket, as SCM_RIGHTS
+    // control messages riding along with data.  The receiver gets new descriptors for the same open files.
+    //
+    // The sender keeps its own descriptors; to hand over a socket, close it once the send succeeds.
+    // Send at least one byte with the descriptors, since a stream socket won't carry control data alone.
+        const std::size_t max_fds_per_message = 253;      // Linux's SCM_MAX_FD
+
+        std::size_t send_fds( socket_t, const void *buffer, std::size_t length, const fd_t *fds, std::size_t count, msg_flags_t = msg_flags_t() );
+
+        template < class Buffer >
+        auto send_fds( socket_t s, const Buffer& b, std::initializer_list< fd_t > fds, msg_flags_t f = msg_flags_t() )
+        -> typename std::enable_if< PlusPlus::stdish::is_bufferlike<Buffer>::value, std::size_t >::type
+           {
+            return send_fds( s, PlusPlus::stdish::bufferlike_data( b ), PlusPlus::stdish::bufferlike_size( b ), fds.begin(), fds.size(), f );
+           }
+
+        template < class Buffer >
+        auto send_fds( socket_t s, const Buffer& b, const std::vector< fd_t >& fds, msg_flags_t f = msg_flags_t() )
+        -> typename std::enable_if< PlusPlus::stdish::is_bufferlike<Buffer>::value, std::size_t >::type
+           {
+            return send_fds( s, PlusPlus::stdish::bufferlike_data( b ), PlusPlus::stdish::bufferlike_size( b ), fds.data(), fds.size(), f );
+           }
+
+    // In its basic form, recv_fds stores up to count received descriptors in fds, and sets count to the number
+    // received.  They're opened close-on-exec, and the caller is responsible for closing them.  Any that don't
+    // fit are closed, and truncated is set, as it is when the kernel cuts the control data short (MSG_CTRUNC).
+    // Either way, the sender passed descriptors that the receiver never got.
+        std::size_t recv_fds( socket_t, void *buffer, std::size_t length, fd_t *fds, std::size_t& count, bool& truncated,
+                              msg_flags_t = msg_flags_t() );
+
+    // The other form seizes the received descriptors as unique_fd, unique_socket or unique_socket_in_domain,
+    // appending up to max of them to owners.  Room is made before receiving, so nothing can throw between
+    // the arrival of a descriptor and its seizure.
+        template < class Buffer, class Owner >
+        auto recv_fds( socket_t s, Buffer& b, std::vector< Owner >& owners, bool& truncated, std::size_t max = 1, msg_flags_t f = msg_flags_t() )
+        -> typename std::enable_if< PlusPlus::stdish::is_bufferlike<Buffer>::value, std::size_t >::type
+           {
+            using Descriptor = typename std::remove_const< typename Owner::element_type >::type;
+
+            fd_t received[ max_fds_per_message ];
+            std::size_t count = std::min( max, max_fds_per_message );
+
+            owners.reserve( owners.size() + count );
+
+            std::size_t length = recv_fds( s, PlusPlus::stdish::bufferlike_data( b ), PlusPlus::stdish::bufferlike_size( b ), received, count, truncated, f );
+
+            for ( std::size_t i = 0; i < count; ++i )
+                owners.push_back( Seize< Owner >( Wrap< Descriptor >( Unwrap( received[i] ) ) ) );
+
+            return length;
+           }
+   }
+
+#endif
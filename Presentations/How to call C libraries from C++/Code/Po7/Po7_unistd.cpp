@@ -0,0 +1,86 @@
+//
+//  Po7_unistd.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_unistd.h"
+#include "Po7_ResultGroups.h"
+
+void Po7::FileDescriptorDeleter::operator()( pointer p ) const
+   {
+    // Don't use Invoke in the deleter; this must ignore errors
+
+    int descriptor = Unwrap( *p );
+
+    if ( descriptor != -1 )
+        ::close( descriptor );
+   }
+
+void Po7::close( unique_fd d )
+   {
+    return Invoke( FailureFlagResult<int>(),
+                   ::close,
+                   In( std::move( d ) ),
+                   ThrowErrorFromErrno() );
+   }
+
+std::size_t Po7::read( fd_t d, void *buffer, std::size_t length )
+   {
+    return Invoke( ssize_t_Result(),
+                   ::read,
+                   In( d, buffer, length ),
+                   ThrowErrorFromErrno() );
+   }
+
+std::size_t Po7::write( fd_t d, const void *buffer, std::size_t length )
+   {
+    return Invoke( ssize_t_Result(),
+                   ::write,
+                   In( d, buffer, length ),
+                   ThrowErrorFromErrno() );
+   }
+
+std::size_t Po7::pread( fd_t d, void *buffer, std::size_t length, ::off_t offset )
+   {
+    return Invoke( ssize_t_Result(),
+                   ::pread,
+                   In( d, buffer, length, offset ),
+                   ThrowErrorFromErrno() );
+   }
+
+std::size_t Po7::pwrite( fd_t d, const void *buffer, std::size_t length, ::off_t offset )
+   {
+    return Invoke( ssize_t_Result(),
+                   ::pwrite,
+                   In( d, buffer, length, offset ),
+                   ThrowErrorFromErrno() );
+   }
+
+std::size_t Po7::pread_all( fd_t d, void *buffer, std::size_t length, ::off_t offset )
+   {
+    char *bytes = static_cast< char * >( buffer );
+    std::size_t total = 0;
+
+    while ( total < length )
+       {
+        std::size_t n = pread( d, bytes + total, length - total, offset + static_cast< ::off_t >( total ) );
+
+        if ( n == 0 )
+            break;
+
+        total += n;
+       }
+
+    return total;
+   }
+
+void Po7::pwrite_all( fd_t d, const void *buffer, std::size_t length, ::off_t offset )
+   {
+    const char *bytes = static_cast< const char * >( buffer );
+    std::size_t total = 0;
+
+    while ( total < length )
+        total += pwrite( d, bytes + total, length - total, offset + static_cast< ::off_t >( total ) );
+   }
@@ -0,0 +1,87 @@
+//
+//  Po7_unistd.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_UNISTD_H
+#define PO7_UNISTD_H
+
+#include "Po7_Basics.h"
+
+#include "bufferlike.h"
+
+#include <memory>
+#include <type_traits>
+
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace Po7
+   {
+    // fd_t represents any file descriptor.  More specific descriptor types, like socket_t, convert to it.
+        struct FileDescriptorTag
+           {
+            constexpr int operator()() const            { return -1; }
+            static const bool hasEquality               = true;
+            static const bool hasComparison             = true;
+           };
+
+        using fd_t = PlusPlus::Boxed< FileDescriptorTag >;
+
+    // unique_fd refers to a file descriptor, and represents the obligation to close it
+        struct FileDescriptorDeleter
+           {
+            using pointer = PlusPlus::PointerToValue< fd_t >;
+            void operator()( pointer d ) const;
+           };
+
+        using unique_fd = std::unique_ptr< const fd_t, FileDescriptorDeleter >;
+
+    // Calling close allows any final errors to be thrown.
+        void close( unique_fd );
+
+    // read and write transfer data at the descriptor's own offset, and advance it.  pread and pwrite take
+    // an offset of their own and leave the descriptor's alone, so several threads can share one descriptor.
+    // Each makes one call, which may transfer less than was asked; read and pread return zero at end of file.
+        std::size_t read(   fd_t,       void *buffer, std::size_t length );
+        std::size_t write(  fd_t, const void *buffer, std::size_t length );
+        std::size_t pread(  fd_t,       void *buffer, std::size_t length, ::off_t offset );
+        std::size_t pwrite( fd_t, const void *buffer, std::size_t length, ::off_t offset );
+
+        template < class Buffer >
+        auto read( fd_t d, Buffer& b )
+        -> typename std::enable_if< PlusPlus::stdish::is_bufferlike<Buffer>::value, std::size_t >::type
+           {
+            return read( d, PlusPlus::stdish::bufferlike_data( b ), PlusPlus::stdish::bufferlike_size( b ) );
+           }
+
+        template < class Buffer >
+        auto write( fd_t d, const Buffer& b )
+        -> typename std::enable_if< PlusPlus::stdish::is_bufferlike<Buffer>::value, std::size_t >::type
+           {
+            return write( d, PlusPlus::stdish::bufferlike_data( b ), PlusPlus::stdish::bufferlike_size( b ) );
+           }
+
+        template < class Buffer >
+        auto pread( fd_t d, Buffer& b, ::off_t offset )
+        -> typename std::enable_if< PlusPlus::stdish::is_bufferlike<Buffer>::value, std::size_t >::type
+           {
+            return pread( d, PlusPlus::stdish::bufferlike_data( b ), PlusPlus::stdish::bufferlike_size( b ), offset );
+           }
+
+        template < class Buffer >
+        auto pwrite( fd_t d, const Buffer& b, ::off_t offset )
+        -> typename std::enable_if< PlusPlus::stdish::is_bufferlike<Buffer>::value, std::size_t >::type
+           {
+            return pwrite( d, PlusPlus::stdish::bufferlike_data( b ), PlusPlus::stdish::bufferlike_size( b ), offset );
+           }
+
+    // pread_all and pwrite_all repeat the call until length bytes are transferred.  pread_all stops early
+    // only at end of file, and returns the number of bytes it read.
+        std::size_t pread_all(  fd_t,       void *buffer, std::size_t length, ::off_t offset );
+        void        pwrite_all( fd_t, const void *buffer, std::size_t length, ::off_t offset );
+   }
+
+#endif
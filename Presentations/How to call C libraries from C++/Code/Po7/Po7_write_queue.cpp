@@ -0,0 +1,211 @@
+//
+//  Po7_write_queue.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_write_queue.h"
+
+#include <stdexcept>
+
+bool Po7::write_budget::try_reserve( std::size_t n )
+   {
+    std::size_t current = reserved;
+
+    do
+       {
+        if ( n > capacity - current )
+            return false;
+       }
+    while ( !reserved.compare_exchange_weak( current, current + n ) );
+
+    return true;
+   }
+
+Po7::write_queue::write_queue( std::size_t lowWatermark, std::size_t highWatermark, write_budget *b, pressure_handler h )
+   : lowWater( lowWatermark ),
+     highWater( highWatermark ),
+     budget( b ),
+     onPressure( std::move( h ) )
+   {
+    if ( lowWatermark >= highWatermark )
+        throw std::invalid_argument( "write_queue's low watermark must be below its high watermark" );
+   }
+
+Po7::write_queue::~write_queue()
+   {
+    Release();
+   }
+
+// A moved-from queue is empty, so it has no budget left to give back.
+Po7::write_queue::write_queue( write_queue&& other )
+   : buffers( std::move( other.buffers ) ),
+     frontSent( other.frontSent ),
+     queued( other.queued ),
+     lowWater( other.lowWater ),
+     highWater( other.highWater ),
+     budget( other.budget ),
+     onPressure( std::move( other.onPressure ) ),
+     isPaused( other.isPaused )
+   {
+    other.buffers.clear();
+    other.frontSent = 0;
+    other.queued    = 0;
+    other.isPaused  = false;
+   }
+
+auto Po7::write_queue::operator=( write_queue&& other ) -> write_queue&
+   {
+    if ( this != &other )
+       {
+        Release();
+
+        buffers    = std::move( other.buffers );
+        frontSent  = other.frontSent;
+        queued     = other.queued;
+        lowWater   = other.lowWater;
+        highWater  = other.highWater;
+        budget     = other.budget;
+        onPressure = std::move( other.onPressure );
+        isPaused   = other.isPaused;
+
+        other.buffers.clear();
+        other.frontSent = 0;
+        other.queued    = 0;
+        other.isPaused  = false;
+       }
+
+    return *this;
+   }
+
+bool Po7::write_queue::Reserve( std::size_t n )
+   {
+    return budget == nullptr || budget->try_reserve( n );
+   }
+
+void Po7::write_queue::Release()
+   {
+    if ( budget != nullptr )
+        budget->release( queued );
+
+    buffers.clear();
+    frontSent = 0;
+    queued    = 0;
+   }
+
+void Po7::write_queue::Queued()
+   {
+    if ( !isPaused && queued >= highWater )
+       {
+        isPaused = true;
+        if ( onPressure )
+            onPressure( true );
+       }
+   }
+
+void Po7::write_queue::Sent( std::size_t n )
+   {
+    if ( budget != nullptr )
+        budget->release( n );
+
+    queued -= n;
+
+    while ( n != 0 )
+       {
+        std::size_t rest = buffers.front().size() - frontSent;
+
+        if ( n < rest )
+           {
+            frontSent += n;
+            break;
+           }
+
+        n -= rest;
+        buffers.pop_front();
+        frontSent = 0;
+       }
+
+    if ( isPaused && queued <= lowWater )
+       {
+        isPaused = false;
+        if ( onPressure )
+            onPressure( false );
+       }
+   }
+
+bool Po7::write_queue::push( std::string buffer )
+   {
+    if ( buffer.empty() )
+        return true;
+
+    if ( !Reserve( buffer.size() ) )
+        return false;
+
+    queued += buffer.size();
+    buffers.push_back( std::move( buffer ) );
+    Queued();
+
+    return true;
+   }
+
+bool Po7::write_queue::send( socket_t s, const void *data, std::size_t size )
+   {
+    const char *bytes = static_cast< const char * >( data );
+
+    if ( empty() )
+       {
+        while ( size != 0 )
+           {
+            try_result result = try_send( s, bytes, size, msg_nosignal );
+            if ( result.would_block() )
+                break;
+
+            bytes += result.size();
+            size  -= result.size();
+           }
+       }
+
+    return push( std::string( bytes, size ) );
+   }
+
+bool Po7::write_queue::try_flush( socket_t s )
+   {
+    while ( !empty() )
+       {
+        vectors.clear();
+
+        for ( auto& buffer : buffers )
+           {
+            if ( vectors.size() == iov_max )
+                break;
+
+            std::size_t skip = vectors.empty() ? frontSent : 0;
+
+            iovec vector;
+            vector.iov_base = &buffer[ skip ];
+            vector.iov_len  = buffer.size() - skip;
+            vectors.push_back( vector );
+           }
+
+        try_result result = try_sendmsg( s, Make< msghdr >( vectors.data(), vectors.size() ), msg_nosignal );
+        if ( result.would_block() )
+            return false;
+
+        Sent( result.size() );
+       }
+
+    return true;
+   }
+
+void Po7::write_queue::clear()
+   {
+    Release();
+
+    if ( isPaused )
+       {
+        isPaused = false;
+        if ( onPressure )
+            onPressure( false );
+       }
+   }
@@ -0,0 +1,130 @@
+//
+//  Po7_write_queue.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_WRITE_QUEUE_H
+#define PO7_WRITE_QUEUE_H
+
+#include "Po7_socket.h"
+#include "Po7_uio.h"
+
+#include "bufferlike.h"
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Po7
+   {
+    // write_budget caps the bytes waiting in all the write_queues that share it, so that many slow readers
+    // together can't exhaust memory any more than one can.  It may be shared among threads.
+        class write_budget
+           {
+            private:
+                std::atomic< std::size_t >  reserved;
+                const std::size_t           capacity;
+
+            public:
+                explicit write_budget( std::size_t limit )      : reserved( 0 ), capacity( limit ) {}
+
+                write_budget( const write_budget& )             = delete;
+                write_budget& operator=( const write_budget& )  = delete;
+
+            // try_reserve takes n bytes from the budget, if they're there; release gives them back.
+                bool try_reserve( std::size_t n );
+                void release( std::size_t n )                   { reserved -= n; }
+
+                std::size_t used() const                        { return reserved; }
+                std::size_t limit() const                       { return capacity; }
+           };
+
+
+    // write_queue holds the data a non-blocking socket hasn't taken yet, and sends it as the socket becomes
+    // writable.  The queue owns its buffers, so the producer can forget them once they're queued.
+    //
+    // The watermarks tell the producer when to stop: when the bytes waiting reach the high watermark, the
+    // pressure handler is called with true, and the producer should stop producing (stop reading the request
+    // that produces the data, say, by watching only for epollout).  When try_flush drains them to the low
+    // watermark, the handler is called with false, and the producer may resume.  The handler is called from
+    // within push, send, or try_flush.
+    //
+    // The budget is a hard limit.  When it can't cover a buffer, push and send queue nothing and return false;
+    // the connection is then asking for more memory than the process can give it, and is best closed.
+    //
+    // A write_queue is meant for one thread, such as an event_loop's; only the budget is shared.
+        class write_queue
+           {
+            public:
+                using pressure_handler = std::function< void ( bool paused ) >;
+
+            private:
+                std::deque< std::string >   buffers;
+                std::vector< iovec >        vectors;
+                std::size_t                 frontSent   = 0;    // how much of the first buffer has been sent
+                std::size_t                 queued      = 0;    // bytes waiting, counting from frontSent
+                std::size_t                 lowWater;
+                std::size_t                 highWater;
+                write_budget               *budget;
+                pressure_handler            onPressure;
+                bool                        isPaused    = false;
+
+                bool Reserve( std::size_t );
+                void Queued();
+                void Sent( std::size_t );
+                void Release();
+
+            public:
+            // With no budget, only the watermarks limit the queue, and only if the producer heeds them.
+                write_queue( std::size_t lowWatermark, std::size_t highWatermark,
+                             write_budget * = nullptr, pressure_handler = pressure_handler() );
+                ~write_queue();
+
+                write_queue( write_queue&& );
+                write_queue& operator=( write_queue&& );
+
+                write_queue( const write_queue& )               = delete;
+                write_queue& operator=( const write_queue& )    = delete;
+
+            // push queues a buffer, taking it over.
+                bool push( std::string );
+
+                template < class Buffer >
+                auto push( const Buffer& b )
+                -> typename std::enable_if< PlusPlus::stdish::is_bufferlike<Buffer>::value, bool >::type
+                   {
+                    return push( std::string( PlusPlus::stdish::bufferlike_data( b ), PlusPlus::stdish::bufferlike_size( b ) ) );
+                   }
+
+            // send writes to the socket directly when nothing is waiting, and queues only what the socket doesn't
+            // take, so a connection that keeps up never copies.  If the budget refuses the rest, part of the data
+            // may already be gone, and the connection can't continue.
+                bool send( socket_t, const void *data, std::size_t size );
+
+                template < class Buffer >
+                auto send( socket_t s, const Buffer& b )
+                -> typename std::enable_if< PlusPlus::stdish::is_bufferlike<Buffer>::value, bool >::type
+                   {
+                    return send( s, PlusPlus::stdish::bufferlike_data( b ), PlusPlus::stdish::bufferlike_size( b ) );
+                   }
+
+            // try_flush sends until the queue is empty or the socket would block, gathering up to iov_max
+            // buffers per sendmsg, and says whether the queue is empty.  Call it when the socket is writable.
+                bool try_flush( socket_t );
+
+            // clear discards everything waiting, as when the connection closes, and gives back its budget.
+                void clear();
+
+                std::size_t size() const                        { return queued; }
+                bool empty() const                              { return queued == 0; }
+                bool paused() const                             { return isPaused; }
+           };
+   }
+
+#endif
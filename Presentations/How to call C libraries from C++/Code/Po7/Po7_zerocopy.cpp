@@ -0,0 +1,170 @@
+//
+//  Po7_zerocopy.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#include "Po7_zerocopy.h"
+#include "Po7_sockopt.h"
+#include "Po7_ResultGroups.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <netinet/in.h>
+#include <linux/errqueue.h>
+
+namespace
+   {
+    const sock_extended_err *ZerocopyNotification( const cmsghdr& c )
+       {
+        bool isRecvErr = ( c.cmsg_level == SOL_IP   && c.cmsg_type == IP_RECVERR )
+                      || ( c.cmsg_level == SOL_IPV6 && c.cmsg_type == IPV6_RECVERR );
+        if ( !isRecvErr )
+            return nullptr;
+
+        const sock_extended_err *error = reinterpret_cast< const sock_extended_err * >( CMSG_DATA( &c ) );
+        if ( error->ee_errno != 0 || error->ee_origin != SO_EE_ORIGIN_ZEROCOPY )
+            return nullptr;
+
+        return error;
+       }
+   }
+
+Po7::zerocopy_sender::zerocopy_sender( socket_t s )
+   : socket( s )
+   {
+    setsockopt< so_zerocopy >( socket, true );
+   }
+
+std::uint64_t Po7::zerocopy_sender::Send( std::unique_ptr< pinned_buffer > buffer, completion done, msg_flags_t flags )
+   {
+    const char *data       = static_cast< const char * >( buffer->data() );
+    const std::size_t size = buffer->size();
+
+    // Make room for the record before sending, so nothing can fail between sending and pinning.
+    sends.push_back( pending_send{ nextSequence, nextKernelSequence, 0, 0, false, std::move( buffer ), std::move( done ) } );
+    pending_send& record = sends.back();
+    const std::uint64_t sequence = nextSequence++;
+
+    std::size_t sent = 0;
+
+    try
+       {
+        while ( sent < size )
+           {
+            sent += Po7::send( socket, data + sent, size - sent, flags | msg_zerocopy );
+            ++nextKernelSequence;
+            ++record.parts;
+            ++record.outstanding;
+           }
+       }
+    catch ( ... )
+       {
+        if ( record.parts == 0 )
+            sends.pop_back();
+        else
+            ++unfinished;
+        throw;
+       }
+
+    if ( record.parts == 0 )
+       {
+        completion finished = std::move( record.onComplete );
+        sends.pop_back();
+        if ( finished )
+            finished( sequence, false );
+        return sequence;
+       }
+
+    ++unfinished;
+    return sequence;
+   }
+
+std::size_t Po7::zerocopy_sender::Complete( std::uint32_t first, std::uint32_t last, bool copied )
+   {
+    if ( sends.empty() )
+        return 0;
+
+    // Count from the oldest record, so the kernel's numbers can wrap around.
+    const std::uint32_t base  = sends.front().firstKernelSequence;
+    const std::uint32_t begin = first - base;
+    const std::uint32_t end   = last - base + 1;
+
+    for ( pending_send& record : sends )
+       {
+        const std::uint32_t recordBegin = record.firstKernelSequence - base;
+        const std::uint32_t recordEnd   = recordBegin + record.parts;
+
+        if ( recordBegin >= end )
+            break;
+
+        const std::uint32_t overlapBegin = std::max( recordBegin, begin );
+        const std::uint32_t overlapEnd   = std::min( recordEnd, end );
+
+        if ( overlapBegin < overlapEnd && record.outstanding != 0 )
+           {
+            record.outstanding -= std::min( record.outstanding, overlapEnd - overlapBegin );
+            record.copied = record.copied || copied;
+           }
+       }
+
+    // Callbacks may send, appending records, so walk by index.  A record whose buffer is gone has been reported.
+    std::size_t completed = 0;
+
+    for ( std::size_t i = 0; i < sends.size(); ++i )
+       {
+        pending_send& record = sends[ i ];
+
+        if ( record.outstanding != 0 || !record.buffer )
+            continue;
+
+        record.buffer.reset();
+        completion finished = std::move( record.onComplete );
+        --unfinished;
+        ++completed;
+
+        if ( finished )
+            finished( record.sequence, record.copied );
+       }
+
+    while ( !sends.empty() && sends.front().outstanding == 0 && !sends.front().buffer )
+        sends.pop_front();
+
+    return completed;
+   }
+
+std::size_t Po7::zerocopy_sender::reap()
+   {
+    std::size_t completed = 0;
+
+    for (;;)
+       {
+        union
+           {
+            char    bytes[ CMSG_SPACE( sizeof( sock_extended_err ) + sizeof( sockaddr_in6 ) ) ];
+            cmsghdr alignment;
+           } control;
+
+        msghdr message;
+        std::memset( &message, 0, sizeof( message ) );
+        message.msg_control    = control.bytes;
+        message.msg_controllen = sizeof( control.bytes );
+
+        bool received = Invoke( ssize_t_ReadyResult(),
+                                ::recvmsg,
+                                In( socket ),
+                                InOut( message ),
+                                In( msg_errqueue ),
+                                ThrowErrorFromErrno() );
+        if ( !received )
+            return completed;
+
+        for ( cmsghdr *c = CMSG_FIRSTHDR( &message ); c != nullptr; c = CMSG_NXTHDR( &message, c ) )
+            if ( const sock_extended_err *notification = ZerocopyNotification( *c ) )
+                completed += Complete( notification->ee_info,
+                                       notification->ee_data,
+                                       ( notification->ee_code & SO_EE_CODE_ZEROCOPY_COPIED ) != 0 );
+       }
+   }
@@ -0,0 +1,122 @@
+//
+//  Po7_zerocopy.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef PO7_ZEROCOPY_H
+#define PO7_ZEROCOPY_H
+
+#include "Po7_socket.h"
+
+#include "bufferlike.h"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+namespace Po7
+   {
+    // zerocopy_sender sends with MSG_ZEROCOPY: the kernel transmits straight from the caller's memory
+    // instead of copying it.  That memory must stay put until the kernel says it's done, so the sender takes
+    // ownership of each buffer -- pass an rvalue string, vector, or array, or a unique_ptr to one -- and
+    // holds it until the completion arrives on the socket's error queue.
+    //
+    // Completions are collected by reap, which never blocks.  The socket reports epollerr when completions
+    // are waiting; a handler registered with event_loop can call reap then.  For each send, the completion
+    // callback receives the sequence number send returned, and whether the kernel fell back to copying
+    // (as it does on loopback).  The buffer is released just before the callback is called.
+    //
+    // Zero-copy only pays for large sends.  The sender must be the only source of MSG_ZEROCOPY sends on its socket,
+    // and it should outlive them: destroying it releases buffers the kernel may still be transmitting.
+        class zerocopy_sender
+           {
+            public:
+                using completion = std::function< void ( std::uint64_t sequence, bool copied ) >;
+
+            private:
+                struct pinned_buffer
+                   {
+                    virtual ~pinned_buffer()                    {}
+                    virtual const void *data() const = 0;
+                    virtual std::size_t size() const = 0;
+                   };
+
+                template < class Owner >
+                struct pinned: pinned_buffer
+                   {
+                    Owner owner;
+
+                    explicit pinned( Owner&& o )                : owner( std::move( o ) ) {}
+
+                    const void *data() const override           { return PinnedData( owner ); }
+                    std::size_t size() const override           { return PinnedSize( owner ); }
+                   };
+
+                template < class Buffer >
+                static const void *PinnedData( const Buffer& b )                           { return PlusPlus::stdish::bufferlike_data( b ); }
+
+                template < class Buffer >
+                static std::size_t PinnedSize( const Buffer& b )                           { return PlusPlus::stdish::bufferlike_size( b ); }
+
+                template < class Buffer, class D >
+                static const void *PinnedData( const std::unique_ptr< Buffer, D >& p )      { return p ? PinnedData( *p ) : nullptr; }
+
+                template < class Buffer, class D >
+                static std::size_t PinnedSize( const std::unique_ptr< Buffer, D >& p )      { return p ? PinnedSize( *p ) : 0; }
+
+                template < class Owner >
+                struct is_pinnable: PlusPlus::stdish::is_bufferlike< Owner > {};
+
+                template < class Buffer, class D >
+                struct is_pinnable< std::unique_ptr< Buffer, D > >: PlusPlus::stdish::is_bufferlike< Buffer > {};
+
+                struct pending_send
+                   {
+                    std::uint64_t                     sequence;
+                    std::uint32_t                     firstKernelSequence;  // the kernel numbers each send call
+                    std::uint32_t                     parts;                // how many calls this send took
+                    std::uint32_t                     outstanding;          // how many of them haven't completed
+                    bool                              copied;
+                    std::unique_ptr< pinned_buffer >  buffer;
+                    completion                        onComplete;
+                   };
+
+                socket_t                    socket;
+                std::deque< pending_send >  sends;
+                std::size_t                 unfinished         = 0;
+                std::uint64_t               nextSequence       = 0;
+                std::uint32_t               nextKernelSequence = 0;
+
+                std::uint64_t Send( std::unique_ptr< pinned_buffer >, completion, msg_flags_t );
+                std::size_t Complete( std::uint32_t first, std::uint32_t last, bool copied );
+
+            public:
+            // The constructor turns on SO_ZEROCOPY for the socket.
+                explicit zerocopy_sender( socket_t );
+
+                zerocopy_sender( const zerocopy_sender& )               = delete;
+                zerocopy_sender& operator=( const zerocopy_sender& )    = delete;
+
+            // send sends the whole buffer, calling send as many times as it takes, and returns the send's
+            // sequence number.  If a call fails part way, the part already sent stays pending.
+                template < class Owner >
+                auto send( Owner&& owner, completion done = completion(), msg_flags_t flags = msg_flags_t() )
+                -> typename std::enable_if< !std::is_lvalue_reference< Owner >::value && is_pinnable< Owner >::value, std::uint64_t >::type
+                   {
+                    return Send( std::unique_ptr< pinned_buffer >( new pinned< Owner >( std::move( owner ) ) ), std::move( done ), flags );
+                   }
+
+            // reap reads the error queue and calls the callbacks of completed sends.  It returns how many completed.
+            // Callbacks may send more, but shouldn't call reap.
+                std::size_t reap();
+
+            // pending is the number of sends still holding their buffers.
+                std::size_t pending() const                             { return unfinished; }
+           };
+   }
+
+#endif
@@ -0,0 +1,346 @@
+//
+//  invoke_benchmark.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+// invoke_benchmark checks that Po7's layering costs nothing at run time.  Each benchmark does the same work
+// twice: once through Po7, and once by hand in the manner of GreetAndEchoTheHardWay, calling POSIX directly
+// and checking errno after each call.  Both are timed, and where the kernel allows it, the user-space
+// instructions each retires are counted with a hardware performance counter.
+//
+//      invoke_benchmark [--iterations N]
+//
+// Time on a shared machine is noisy, so it is only reported.  Instruction counts are nearly deterministic,
+// so they're checked: if the Po7 form of any benchmark retires more instructions than the hand-written form,
+// beyond a small allowance, the run fails with exit status 1.  Since every Po7 call goes through
+// InvokeWithGroups, Conjugated, and Prefixed, a change that stops those from inlining away shows up here.
+// Kernel instructions are excluded, so the system call itself, which is the same either way, doesn't hide
+// the difference.  Where the counter isn't available (a virtual machine without a PMU, or
+// perf_event_paranoid above 2), the counts are reported as unavailable and only the times are shown.
+//
+// Build it with optimization, as a release would be; at -O0 nothing inlines and the comparison means nothing.
+
+#include "Po7_socket.h"
+#include "Po7_in.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+   {
+    // Results are folded into this, so the optimizer can't discard the work being timed.
+    volatile std::uint64_t sink;
+
+    class InstructionCounter
+       {
+        private:
+            int              descriptor;
+            std::error_code  failure;
+
+        public:
+            InstructionCounter()
+               {
+                perf_event_attr attributes;
+                std::memset( &attributes, 0, sizeof( attributes ) );
+                attributes.size           = sizeof( attributes );
+                attributes.type           = PERF_TYPE_HARDWARE;
+                attributes.config         = PERF_COUNT_HW_INSTRUCTIONS;
+                attributes.disabled       = 1;
+                attributes.exclude_kernel = 1;
+                attributes.exclude_hv     = 1;
+
+                descriptor = static_cast< int >( syscall( SYS_perf_event_open, &attributes, 0, -1, -1, 0 ) );
+                if ( descriptor == -1 )
+                    failure = std::error_code( errno, std::system_category() );
+               }
+
+            ~InstructionCounter()
+               {
+                if ( descriptor != -1 )
+                    close( descriptor );
+               }
+
+            InstructionCounter( const InstructionCounter& )             = delete;
+            InstructionCounter& operator=( const InstructionCounter& )  = delete;
+
+            bool available() const                  { return descriptor != -1; }
+            std::error_code error() const           { return failure; }
+
+            // count runs the work and returns the user-space instructions it retired.
+            std::uint64_t count( const std::function< void () >& work )
+               {
+                ioctl( descriptor, PERF_EVENT_IOC_RESET, 0 );
+                ioctl( descriptor, PERF_EVENT_IOC_ENABLE, 0 );
+                work();
+                ioctl( descriptor, PERF_EVENT_IOC_DISABLE, 0 );
+
+                std::uint64_t result = 0;
+                if ( read( descriptor, &result, sizeof( result ) ) != ssize_t( sizeof( result ) ) )
+                    throw std::system_error( errno, std::system_category() );
+                return result;
+               }
+       };
+
+    struct benchmark
+       {
+        std::string               name;
+        std::size_t               iterations;         // per measurement; slow operations get fewer
+        std::function< void () >  handWritten;        // one operation each call
+        std::function< void () >  po7;
+        double                    allowance;          // instructions per operation Po7 may spend beyond the hand-written form
+       };
+
+    struct measurement
+       {
+        double nanoseconds;
+        double instructions;                          // negative if unavailable
+       };
+
+    measurement Measure( InstructionCounter& counter, const std::function< void () >& operation, std::size_t iterations )
+       {
+        auto loop = [&]()
+           {
+            for ( std::size_t i = 0; i < iterations; ++i )
+                operation();
+           };
+
+        loop();         // warm up caches and the branch predictor
+
+        // The minimum of several runs is the least disturbed by other work on the machine.
+        double best = std::numeric_limits< double >::max();
+        for ( int run = 0; run < 5; ++run )
+           {
+            auto start = std::chrono::steady_clock::now();
+            loop();
+            auto stop  = std::chrono::steady_clock::now();
+            best = std::min( best, std::chrono::duration< double, std::nano >( stop - start ).count() / double( iterations ) );
+           }
+
+        double instructions = -1;
+        if ( counter.available() )
+           {
+            std::uint64_t fewest = std::numeric_limits< std::uint64_t >::max();
+            for ( int run = 0; run < 5; ++run )
+                fewest = std::min( fewest, counter.count( loop ) );
+            instructions = double( fewest ) / double( iterations );
+           }
+
+        return measurement{ best, instructions };
+       }
+
+    // The hand-written forms follow GreetAndEchoTheHardWay: call, compare with -1, throw from errno.
+    void ThrowIf( bool failed )
+       {
+        if ( failed )
+            throw std::system_error( errno, std::system_category() );
+       }
+
+    std::vector< benchmark > Benchmarks( std::size_t iterations )
+       {
+        std::vector< benchmark > result;
+
+        result.push_back( benchmark{ "socket, close", iterations / 10,
+            []()
+               {
+                int s = socket( AF_INET6, SOCK_STREAM, 0 );
+                ThrowIf( s == -1 );
+                sink = sink + std::uint64_t( s );
+                ThrowIf( close( s ) != 0 );
+               },
+            []()
+               {
+                auto s = Po7::socket< Po7::af_inet6 >( Po7::sock_stream, Po7::socket_protocol_t() );
+                sink = sink + std::uint64_t( Po7::Unwrap( *s ) );
+                Po7::close( std::move( s ) );
+               },
+            10 } );
+
+        result.push_back( benchmark{ "socket, bind, close", iterations / 10,
+            []()
+               {
+                sockaddr_in6 address;
+                std::memset( &address, 0, sizeof( address ) );
+                address.sin6_family = AF_INET6;
+                address.sin6_addr   = in6addr_loopback;
+
+                int s = socket( AF_INET6, SOCK_STREAM, 0 );
+                ThrowIf( s == -1 );
+                if ( bind( s, reinterpret_cast< const sockaddr * >( &address ), sizeof( address ) ) != 0 )
+                   {
+                    int error = errno;
+                    close( s );
+                    throw std::system_error( error, std::system_category() );
+                   }
+                ThrowIf( close( s ) != 0 );
+               },
+            []()
+               {
+                auto s = Po7::socket< Po7::af_inet6 >( Po7::sock_stream, Po7::socket_protocol_t() );
+                Po7::bind( *s, Po7::Make< sockaddr_in6 >( in6addr_loopback, Po7::in_port_t() ) );
+                Po7::close( std::move( s ) );
+               },
+            20 } );
+
+        // The sockets below live as long as the benchmarks; the lambdas share them.
+        auto bound = std::make_shared< Po7::unique_socket_in_domain< Po7::af_inet6 > >(
+                        Po7::socket< Po7::af_inet6 >( Po7::sock_stream, Po7::socket_protocol_t() ) );
+        Po7::bind( **bound, Po7::Make< sockaddr_in6 >( in6addr_loopback, Po7::in_port_t() ) );
+
+        result.push_back( benchmark{ "getsockname", iterations,
+            [bound]()
+               {
+                sockaddr_in6 address;
+                socklen_t length = sizeof( address );
+                ThrowIf( getsockname( Po7::Unwrap( **bound ), reinterpret_cast< sockaddr * >( &address ), &length ) != 0 );
+                sink = sink + address.sin6_port;
+               },
+            [bound]()
+               {
+                sockaddr_in6 address = Po7::getsockname( **bound );
+                sink = sink + address.sin6_port;
+               },
+            10 } );
+
+        auto pair = std::make_shared< std::tuple< Po7::unique_socket, Po7::unique_socket > >(
+                        Po7::socketpair( Po7::af_unix, Po7::sock_stream, Po7::socket_protocol_t() ) );
+
+        result.push_back( benchmark{ "send, recv 64 bytes", iterations,
+            [pair]()
+               {
+                char buffer[ 64 ] = {};
+                int  a = Po7::Unwrap( *std::get<0>( *pair ) );
+                int  b = Po7::Unwrap( *std::get<1>( *pair ) );
+
+                ThrowIf( send( a, buffer, sizeof( buffer ), 0 ) == -1 );
+                ssize_t received = recv( b, buffer, sizeof( buffer ), 0 );
+                ThrowIf( received == -1 );
+                sink = sink + std::uint64_t( received );
+               },
+            [pair]()
+               {
+                char buffer[ 64 ] = {};
+
+                Po7::send( *std::get<0>( *pair ), buffer );
+                sink = sink + Po7::recv( *std::get<1>( *pair ), buffer );
+               },
+            10 } );
+
+        sockaddr_in6 sample = Po7::getsockname( **bound );
+
+        result.push_back( benchmark{ "Make<std::string>( sockaddr_in6 )", iterations,
+            [sample]()
+               {
+                char text[ INET6_ADDRSTRLEN ];
+                ThrowIf( inet_ntop( AF_INET6, &sample.sin6_addr, text, sizeof( text ) ) == nullptr );
+
+                std::string result = "[";
+                result += text;
+                result += "]:";
+                result += std::to_string( ntohs( sample.sin6_port ) );
+                sink = sink + result.size();
+               },
+            [sample]()
+               {
+                sink = sink + Po7::Make< std::string >( sample ).size();
+               },
+            40 } );
+
+        result.push_back( benchmark{ "Make<std::string>( in_port_t )", iterations,
+            [sample]()
+               {
+                sink = sink + std::to_string( ntohs( sample.sin6_port ) ).size();
+               },
+            [sample]()
+               {
+                sink = sink + Po7::Make< std::string >( Po7::Wrap< Po7::in_port_t >( sample.sin6_port ) ).size();
+               },
+            10 } );
+
+        return result;
+       }
+
+    std::string CurrentExceptionString()
+       {
+        try { throw; }
+        catch ( const std::exception& e )       { return e.what(); }
+        catch ( ... )                           { return "[unknown]"; }
+       }
+   }
+
+int main( int argc, char *argv[] )
+   {
+    try
+       {
+        std::size_t iterations = 100000;
+
+        for ( int i = 1; i < argc; ++i )
+           {
+            std::string arg = argv[i];
+            if ( arg == "--iterations" && i + 1 < argc )
+                iterations = std::max< std::size_t >( 10, std::stoul( argv[++i] ) );
+            else
+                throw std::invalid_argument( "usage: invoke_benchmark [--iterations N]" );
+           }
+
+        InstructionCounter counter;
+        bool               regressed = false;
+
+        if ( !counter.available() )
+            std::cout << "Instruction counts unavailable: " << counter.error().message() << "\n";
+
+        std::cout << std::left << std::setw( 36 ) << "benchmark"
+                  << std::right << std::setw( 12 ) << "POSIX ns" << std::setw( 12 ) << "Po7 ns"
+                  << std::setw( 14 ) << "POSIX instr" << std::setw( 12 ) << "Po7 instr" << "\n";
+
+        for ( const benchmark& b : Benchmarks( iterations ) )
+           {
+            measurement handWritten = Measure( counter, b.handWritten, b.iterations );
+            measurement po7         = Measure( counter, b.po7,         b.iterations );
+
+            std::cout << std::left << std::setw( 36 ) << b.name << std::right << std::fixed << std::setprecision( 1 )
+                      << std::setw( 12 ) << handWritten.nanoseconds << std::setw( 12 ) << po7.nanoseconds;
+
+            if ( counter.available() )
+               {
+                bool failed = po7.instructions > handWritten.instructions + b.allowance;
+                regressed = regressed || failed;
+
+                std::cout << std::setw( 14 ) << handWritten.instructions << std::setw( 12 ) << po7.instructions
+                          << ( failed ? "  REGRESSION" : "" );
+               }
+
+            std::cout << "\n";
+           }
+
+        std::cout << std::flush;
+        return regressed ? 1 : 0;
+       }
+    catch ( ... )
+       {
+        std::cerr << "Exiting with unknown exception: " << CurrentExceptionString() << std::endl;
+        return 1;
+       }
+   }
@@ -0,0 +1,127 @@
+//
+//  latency_histogram.h
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// latency_histogram counts durations in the manner of HdrHistogram: buckets are linear within each power of
+// two and double in width from one power to the next, so every recorded value is kept to within 1/128 of
+// itself (under 0.8%) from a nanosecond up to the largest duration a uint64_t of nanoseconds can hold.
+// Recording is a few shifts and an increment, and never allocates; histograms from several threads can be
+// merged afterward.
+
+class latency_histogram
+   {
+    public:
+        using duration = std::chrono::nanoseconds;
+
+    private:
+        static const unsigned  subBucketBits = 8;
+        static const unsigned  subBucketHalf = 1u << ( subBucketBits - 1 );
+        static const unsigned  buckets       = ( 64 - subBucketBits + 2 ) * subBucketHalf;
+
+        std::vector< std::uint64_t >  counts;
+        std::uint64_t                 total   = 0;
+        std::uint64_t                 minimum = std::numeric_limits< std::uint64_t >::max();
+        std::uint64_t                 maximum = 0;
+        double                        sum     = 0;
+
+        static unsigned HighestBit( std::uint64_t v )
+           {
+            return 63u - static_cast< unsigned >( __builtin_clzll( v ) );
+           }
+
+        static std::size_t IndexOf( std::uint64_t v )
+           {
+            if ( v < ( std::uint64_t( 1 ) << subBucketBits ) )
+                return static_cast< std::size_t >( v );
+
+            unsigned shift = HighestBit( v ) - ( subBucketBits - 1 );
+            return std::size_t( shift ) * subBucketHalf + static_cast< std::size_t >( v >> shift );
+           }
+
+        // The largest value that lands in the same bucket, which is what a percentile reports.
+        static std::uint64_t HighestEquivalent( std::size_t index )
+           {
+            if ( index < ( std::size_t( 1 ) << subBucketBits ) )
+                return index;
+
+            unsigned      shift = static_cast< unsigned >( index / subBucketHalf - 1 );
+            std::uint64_t sub   = index - std::uint64_t( shift ) * subBucketHalf;
+            return ( sub << shift ) + ( ( std::uint64_t( 1 ) << shift ) - 1 );
+           }
+
+    public:
+        latency_histogram()
+           : counts( buckets, 0 )
+           {}
+
+        void record( duration d )
+           {
+            std::uint64_t v = d.count() < 0 ? 0 : static_cast< std::uint64_t >( d.count() );
+
+            ++counts[ IndexOf( v ) ];
+            ++total;
+            minimum = std::min( minimum, v );
+            maximum = std::max( maximum, v );
+            sum    += double( v );
+           }
+
+        void merge( const latency_histogram& other )
+           {
+            for ( std::size_t i = 0; i < buckets; ++i )
+                counts[ i ] += other.counts[ i ];
+
+            total  += other.total;
+            minimum = std::min( minimum, other.minimum );
+            maximum = std::max( maximum, other.maximum );
+            sum    += other.sum;
+           }
+
+        void clear()
+           {
+            std::fill( counts.begin(), counts.end(), 0 );
+            total   = 0;
+            minimum = std::numeric_limits< std::uint64_t >::max();
+            maximum = 0;
+            sum     = 0;
+           }
+
+        std::uint64_t size() const                  { return total; }
+        duration min() const                        { return duration( total == 0 ? 0 : minimum ); }
+        duration max() const                        { return duration( maximum ); }
+        duration mean() const                       { return duration( total == 0 ? 0 : static_cast< std::int64_t >( sum / double( total ) ) ); }
+
+        // percentile takes a fraction, such as 0.999; the result is no smaller than that fraction of the values.
+        duration percentile( double fraction ) const
+           {
+            if ( total == 0 )
+                return duration( 0 );
+
+            std::uint64_t wanted = static_cast< std::uint64_t >( std::ceil( fraction * double( total ) ) );
+            wanted = std::max< std::uint64_t >( 1, std::min( wanted, total ) );
+
+            std::uint64_t seen = 0;
+            for ( std::size_t i = 0; i < buckets; ++i )
+               {
+                seen += counts[ i ];
+                if ( seen >= wanted )
+                    return duration( static_cast< std::int64_t >( std::min( HighestEquivalent( i ), maximum ) ) );
+               }
+
+            return duration( static_cast< std::int64_t >( maximum ) );
+           }
+   };
+
+#endif
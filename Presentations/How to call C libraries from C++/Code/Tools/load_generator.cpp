@@ -0,0 +1,486 @@
+//
+//  load_generator.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+// load_generator drives traffic at a Po7 server over loopback and reports throughput and latency.
+//
+//      load_generator address [--connections N] [--threads N] [--rate R] [--size B] [--seconds S]
+//                             [--stream] [--no-greeting]
+//
+// The address is written the way Po7 prints it, [::1]:port or 127.0.0.1:port.  By default each request is
+// B bytes that the server is expected to echo, as GreetAndEchoMany does ("main serve"); with --stream, the
+// requests are only written, which is all GreetAndEcho and GreetAndEchoTheHardWay ("main hardway") do, and
+// a request's latency is the time until the kernel has taken all of it.  The servers greet each client with
+// a line, which is read before the run starts unless --no-greeting is given.
+//
+// The load is open-loop: R requests per second in total, spread evenly over the connections, each sent at
+// a time fixed in advance.  Latency is measured from that intended time, not from when the request actually
+// went out, so a server that stalls is charged for every request that should have been sent during the stall
+// rather than just the one that was waiting.  (A closed-loop generator, which sends the next request when
+// the last one is answered, quietly sends less during a stall and so leaves it out of the percentiles;
+// that's coordinated omission.)  Connections are split among the threads, each running its own event_loop,
+// and their histograms are merged at the end.
+
+#include "Po7_socket.h"
+#include "Po7_in.h"
+#include "Po7_event_loop.h"
+#include "Po7_fcntl.h"
+#include "Po7_sockopt.h"
+#include "Po7_timerfd.h"
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::chrono::steady_clock;
+
+namespace
+   {
+    struct options
+       {
+        std::string                 address;
+        std::size_t                 connections = 1;
+        std::size_t                 threads     = 1;
+        double                      rate        = 1000;     // requests per second, over all connections
+        std::size_t                 size        = 64;       // bytes per request
+        std::chrono::seconds        duration    = std::chrono::seconds( 10 );
+        bool                        streaming   = false;
+        bool                        greeting    = true;
+       };
+
+    struct results
+       {
+        latency_histogram  latency;
+        std::uint64_t      issued        = 0;
+        std::uint64_t      completed     = 0;
+        std::uint64_t      bytesSent     = 0;
+        std::uint64_t      bytesReceived = 0;
+        std::uint64_t      dropped       = 0;       // connections the server closed or reset mid-run
+
+        void merge( const results& other )
+           {
+            latency.merge( other.latency );
+            issued        += other.issued;
+            completed     += other.completed;
+            bytesSent     += other.bytesSent;
+            bytesReceived += other.bytesReceived;
+            dropped       += other.dropped;
+           }
+       };
+
+    template < Po7::socket_domain_t domain >
+    Po7::unique_socket Connect( const Po7::sockaddr_type< domain >& address )
+       {
+        auto s = Po7::socket< domain >( Po7::sock_stream | Po7::sock_cloexec, Po7::socket_protocol_t() );
+        Po7::connect( *s, address );
+        Po7::setsockopt< Po7::tcp_nodelay >( *s, true );
+        return Po7::unique_socket( std::move( s ) );
+       }
+
+    Po7::unique_socket Connect( const std::string& address )
+       {
+        if ( !address.empty() && address[0] == '[' )
+            return Connect< Po7::af_inet6 >( Po7::Make< sockaddr_in6 >( address ) );
+        else
+            return Connect< Po7::af_inet >( Po7::Make< sockaddr_in >( address ) );
+       }
+
+    // The greeting is read while the socket still blocks, so it isn't mistaken for an echo.
+    void SkipGreeting( Po7::socket_t s )
+       {
+        char buffer[ 256 ];
+
+        for (;;)
+           {
+            std::size_t received = Po7::recv( s, buffer );
+            if ( received == 0 )
+                throw std::runtime_error( "the server closed the connection before greeting" );
+            if ( std::find( buffer, buffer + received, '\n' ) != buffer + received )
+                return;
+           }
+       }
+
+    class LoadWorker
+       {
+        private:
+            struct connection
+               {
+                Po7::socket_t                              socket;
+                std::deque< steady_clock::time_point >     unwritten;      // intended send times, oldest first
+                std::deque< steady_clock::time_point >     unanswered;     // written, awaiting the echo
+                std::size_t                                written  = 0;   // of the oldest unwritten request
+                std::size_t                                received = 0;   // of the oldest unanswered echo
+                bool                                       open     = true;
+
+                explicit connection( Po7::socket_t s )
+                   : socket( s )
+                   {}
+               };
+
+            const options&               opts;
+            Po7::event_loop              loop;
+            std::vector< connection >    connections;
+            std::vector< char >          filler;
+            results                      out;
+
+            void Flush( connection& );
+            void Read( connection& );
+            void Drop( connection& );
+            bool Finished() const;
+
+        public:
+            LoadWorker( const options&, std::size_t connectionCount );
+
+            // Run sends the requests due from start until end, then waits up to drainTime for the answers.
+            // This worker owns connections first, first + opts.threads, and so on, of the whole run's.
+            void Run( steady_clock::time_point start, steady_clock::time_point end,
+                      std::size_t first, std::chrono::seconds drainTime );
+
+            const results& result() const               { return out; }
+       };
+
+    LoadWorker::LoadWorker( const options& o, std::size_t connectionCount )
+       : opts( o ),
+         filler( std::max< std::size_t >( o.size, 65536 ), 'x' )
+       {
+        connections.reserve( connectionCount );
+
+        for ( std::size_t i = 0; i < connectionCount; ++i )
+           {
+            Po7::unique_socket s = Connect( opts.address );
+
+            if ( opts.greeting )
+                SkipGreeting( *s );
+
+            Po7::fcntl_setfl( *s, Po7::fcntl_getfl( *s ) | Po7::o_nonblock );
+
+            connections.emplace_back( *s );
+            loop.add( std::move( s ),
+                      Po7::epollin | Po7::epollout | Po7::epollrdhup,
+                      [this, i]( Po7::socket_t, Po7::epoll_events_t )
+                         {
+                          connection& c = connections[ i ];
+                          Read( c );
+                          Flush( c );
+                         } );
+           }
+       }
+
+    // Flush writes queued requests until the socket would block.  Several small requests go out in one send.
+    void LoadWorker::Flush( connection& c )
+       {
+        while ( c.open && !c.unwritten.empty() )
+           {
+            std::size_t pending = c.unwritten.size() * opts.size - c.written;
+            std::size_t length  = std::min( pending, filler.size() );
+
+            Po7::try_result result;
+            try
+               {
+                result = Po7::try_send( c.socket, filler.data(), length, Po7::msg_nosignal );
+               }
+            catch ( const std::system_error& )
+               {
+                Drop( c );
+                return;
+               }
+
+            if ( result.would_block() )
+                return;
+
+            steady_clock::time_point now = steady_clock::now();
+            out.bytesSent += result.size();
+            c.written     += result.size();
+
+            while ( c.written >= opts.size && !c.unwritten.empty() )
+               {
+                c.written -= opts.size;
+
+                if ( opts.streaming )
+                   {
+                    out.latency.record( now - c.unwritten.front() );
+                    ++out.completed;
+                   }
+                else
+                   {
+                    c.unanswered.push_back( c.unwritten.front() );
+                   }
+
+                c.unwritten.pop_front();
+               }
+           }
+       }
+
+    // Read takes echoes until the socket would block.  Each opts.size bytes answers the oldest request.
+    void LoadWorker::Read( connection& c )
+       {
+        char buffer[ 65536 ];
+
+        while ( c.open )
+           {
+            Po7::try_result result;
+            try
+               {
+                result = Po7::try_recv( c.socket, buffer );
+               }
+            catch ( const std::system_error& )
+               {
+                Drop( c );
+                return;
+               }
+
+            if ( result.would_block() )
+                return;
+
+            if ( result.size() == 0 )
+               {
+                Drop( c );
+                return;
+               }
+
+            steady_clock::time_point now = steady_clock::now();
+            out.bytesReceived += result.size();
+
+            if ( opts.streaming )
+                continue;
+
+            c.received += result.size();
+            while ( c.received >= opts.size && !c.unanswered.empty() )
+               {
+                c.received -= opts.size;
+                out.latency.record( now - c.unanswered.front() );
+                ++out.completed;
+                c.unanswered.pop_front();
+               }
+           }
+       }
+
+    // What was still queued on a dropped connection counts as issued but never completed.
+    void LoadWorker::Drop( connection& c )
+       {
+        c.open = false;
+        c.unwritten.clear();
+        c.unanswered.clear();
+        loop.close( c.socket );
+        ++out.dropped;
+       }
+
+    bool LoadWorker::Finished() const
+       {
+        for ( const connection& c : connections )
+            if ( !c.unwritten.empty() || !c.unanswered.empty() )
+                return false;
+
+        return true;
+       }
+
+    void LoadWorker::Run( steady_clock::time_point start, steady_clock::time_point end,
+                          std::size_t first, std::chrono::seconds drainTime )
+       {
+        // Request n of the whole run goes to connection n % opts.connections at start + n / opts.rate.
+        // This worker takes the requests for its own connections, in order.
+        const std::chrono::duration< double >     interval( 1.0 / opts.rate );
+        std::size_t                               round    = 0;
+        std::size_t                               position = 0;
+
+        auto intendedTime = [&]( std::size_t r, std::size_t p )
+           {
+            double n = double( r ) * double( opts.connections ) + double( first + p * opts.threads );
+            return start + std::chrono::duration_cast< steady_clock::duration >( interval * n );
+           };
+
+        if ( connections.empty() )
+            return;
+
+        // epoll waits in milliseconds, which is far coarser than loopback latency, so a timerfd set to the
+        // next send wakes the loop instead.  Its expirations only need clearing.
+        Po7::unique_timerfd timer = Po7::timerfd_create( Po7::clock_monotonic, Po7::tfd_nonblock | Po7::tfd_cloexec );
+        const Po7::timerfd_t sendTimer = *timer;
+        const Po7::fd_t      sendTimerDescriptor( Po7::Unwrap( sendTimer ) );
+
+        loop.add( std::move( timer ), Po7::epollin, [sendTimer]( Po7::fd_t, Po7::epoll_events_t )
+                                                       {
+                                                        while ( Po7::try_timerfd_read( sendTimer ) != 0 )
+                                                           {}
+                                                       } );
+
+        steady_clock::time_point next = intendedTime( round, position );
+
+        for (;;)
+           {
+            steady_clock::time_point now = steady_clock::now();
+
+            while ( next <= now && next < end )
+               {
+                connection& c = connections[ position ];
+                if ( c.open )
+                   {
+                    c.unwritten.push_back( next );
+                    Flush( c );
+                   }
+                ++out.issued;
+
+                if ( ++position == connections.size() )
+                   {
+                    position = 0;
+                    ++round;
+                   }
+                next = intendedTime( round, position );
+               }
+
+            if ( now >= end || loop.size() == 1 )     // only the timer is left
+                break;
+
+            Po7::timerfd_arm( sendTimer, std::min( next, end ) );
+            loop.run_once();
+           }
+
+        loop.close( sendTimerDescriptor );
+
+        steady_clock::time_point deadline = steady_clock::now() + drainTime;
+        while ( !Finished() && loop.size() != 0 && steady_clock::now() < deadline )
+            loop.run_once( std::chrono::milliseconds( 10 ) );
+       }
+
+    options ParseOptions( int argc, char *argv[] )
+       {
+        options o;
+
+        for ( int i = 1; i < argc; ++i )
+           {
+            std::string arg = argv[i];
+
+            auto value = [&]() -> std::string
+               {
+                if ( i + 1 >= argc )
+                    throw std::invalid_argument( arg + " needs a value" );
+                return argv[++i];
+               };
+
+            if      ( arg == "--connections" )      o.connections = std::stoul( value() );
+            else if ( arg == "--threads" )          o.threads     = std::stoul( value() );
+            else if ( arg == "--rate" )             o.rate        = std::stod( value() );
+            else if ( arg == "--size" )             o.size        = std::stoul( value() );
+            else if ( arg == "--seconds" )          o.duration    = std::chrono::seconds( std::stol( value() ) );
+            else if ( arg == "--stream" )           o.streaming   = true;
+            else if ( arg == "--no-greeting" )      o.greeting    = false;
+            else if ( o.address.empty() && arg.compare( 0, 2, "--" ) != 0 )
+                o.address = arg;
+            else
+                throw std::invalid_argument( "unknown argument " + arg );
+           }
+
+        if ( o.address.empty() )
+            throw std::invalid_argument( "usage: load_generator address [--connections N] [--threads N] [--rate R] "
+                                         "[--size B] [--seconds S] [--stream] [--no-greeting]" );
+        if ( o.connections == 0 || o.threads == 0 || o.size == 0 || !( o.rate > 0 ) )
+            throw std::invalid_argument( "connections, threads, size, and rate must be positive" );
+
+        o.threads = std::min( o.threads, o.connections );
+        return o;
+       }
+
+    void Report( const options& o, const results& r, steady_clock::duration elapsed )
+       {
+        double seconds = std::chrono::duration< double >( elapsed ).count();
+
+        auto micros = [&]( latency_histogram::duration d )
+           {
+            return std::chrono::duration< double, std::micro >( d ).count();
+           };
+
+        std::cout << std::fixed << std::setprecision( 1 );
+        std::cout << o.connections << " connections on " << o.threads << " threads, "
+                  << o.rate << " requests/s of " << o.size << " bytes, "
+                  << ( o.streaming ? "streaming" : "request/response" ) << ", " << seconds << " s\n";
+        std::cout << r.issued << " requests issued, " << r.completed << " completed, "
+                  << r.issued - std::min( r.issued, r.completed ) << " unfinished, "
+                  << r.dropped << " connections dropped\n";
+        std::cout << r.completed / seconds << " requests/s, "
+                  << r.bytesSent / seconds / 1e6 << " MB/s sent, "
+                  << r.bytesReceived / seconds / 1e6 << " MB/s received\n";
+        std::cout << "latency (us): min " << micros( r.latency.min() )
+                  << "  p50 "   << micros( r.latency.percentile( 0.50 ) )
+                  << "  p90 "   << micros( r.latency.percentile( 0.90 ) )
+                  << "  p99 "   << micros( r.latency.percentile( 0.99 ) )
+                  << "  p99.9 " << micros( r.latency.percentile( 0.999 ) )
+                  << "  max "   << micros( r.latency.max() )
+                  << "  mean "  << micros( r.latency.mean() ) << std::endl;
+       }
+
+    std::string CurrentExceptionString()
+       {
+        try { throw; }
+        catch ( const std::exception& e )       { return e.what(); }
+        catch ( ... )                           { return "[unknown]"; }
+       }
+   }
+
+int main( int argc, char *argv[] )
+   {
+    try
+       {
+        std::signal( SIGPIPE, SIG_IGN );
+
+        const options o = ParseOptions( argc, argv );
+
+        // Connection c belongs to worker c % threads, so the workers' requests interleave evenly in time.
+        std::vector< std::unique_ptr< LoadWorker > > workers;
+        for ( std::size_t t = 0; t < o.threads; ++t )
+            workers.emplace_back( new LoadWorker( o, ( o.connections - t + o.threads - 1 ) / o.threads ) );
+
+        const steady_clock::time_point start = steady_clock::now() + std::chrono::milliseconds( 100 );
+        const steady_clock::time_point end   = start + o.duration;
+
+        std::vector< std::thread >  threads;
+        std::exception_ptr          failure;
+        std::atomic< bool >         failed( false );
+
+        for ( std::size_t t = 0; t < o.threads; ++t )
+            threads.emplace_back( [&, t]()
+                                     {
+                                      try
+                                         {
+                                          workers[ t ]->Run( start, end, t, std::chrono::seconds( 2 ) );
+                                         }
+                                      catch ( ... )
+                                         {
+                                          if ( !failed.exchange( true ) )
+                                              failure = std::current_exception();
+                                         }
+                                     } );
+
+        for ( std::thread& t : threads )
+            t.join();
+
+        if ( failure )
+            std::rethrow_exception( failure );
+
+        results total;
+        for ( const auto& w : workers )
+            total.merge( w->result() );
+
+        Report( o, total, end - start );
+        return 0;
+       }
+    catch ( ... )
+       {
+        std::cerr << "Exiting with unknown exception: " << CurrentExceptionString() << std::endl;
+        return 1;
+       }
+   }
@@ -0,0 +1,150 @@
+//
+//  smoke_test.cpp
+//  PlusPlus
+//
+//  Released into the public domain.
+//
+
+// smoke_test runs Po7's handles and event_loop over a socketpair, to show that a build works at all.
+//
+//      smoke_test
+//
+// It checks that dereferencing a unique_socket gives the descriptor the socket was made with, before and
+// after the conversions to unique_fd, that socket options can be set through it, that a unique_mapping
+// can be sent as it stands, and that an event_loop delivers a message in each direction.  Each check
+// prints a line; the exit status is 1 if any failed.
+// It's a few milliseconds of work, so it's worth running after building with a new compiler or library.
+
+#include "Po7_socket.h"
+#include "Po7_event_loop.h"
+#include "Po7_fcntl.h"
+#include "Po7_mman.h"
+#include "Po7_sockopt.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <tuple>
+
+#include <sys/socket.h>
+
+namespace
+   {
+    bool failed = false;
+
+    void Check( bool passed, const std::string& what )
+       {
+        std::cout << ( passed ? "ok    " : "FAILED" ) << "  " << what << "\n";
+        failed = failed || !passed;
+       }
+
+    // A descriptor is usable if fcntl will read its flags.
+    bool IsOpen( Po7::fd_t fd )
+       {
+        std::error_code error;
+        Po7::fcntl_getfl( fd, error );
+        return !error;
+       }
+
+    void Handles()
+       {
+        Po7::unique_socket a, b;
+        std::tie( a, b ) = Po7::socketpair( Po7::af_unix, Po7::sock_stream | Po7::sock_cloexec, Po7::socket_protocol_t() );
+
+        const Po7::socket_t& first = *a;
+        int descriptor = Po7::Unwrap( first );
+
+        Check( descriptor > 2 && IsOpen( Po7::fd_t( descriptor ) ), "*unique_socket is an open descriptor" );
+        Check( Po7::Unwrap( *a ) == descriptor && Po7::Unwrap( *b ) != descriptor, "*unique_socket stays the same" );
+
+        Po7::setsockopt< Po7::so_sndbuf >( *a, Po7::buffer_size_t( 1 << 16 ) );
+        Check( Po7::getsockopt< Po7::so_sndbuf >( *a ) >= Po7::buffer_size_t( 1 << 16 ), "socket options through *unique_socket" );
+
+        Po7::unique_fd fd( std::move( a ) );
+        Check( !a && Po7::Unwrap( *fd ) == descriptor, "unique_socket converts to unique_fd" );
+
+        Po7::close( std::move( fd ) );
+        Check( !IsOpen( Po7::fd_t( descriptor ) ), "close releases the descriptor" );
+       }
+
+    void Mapping()
+       {
+        Po7::unique_socket a, b;
+        std::tie( a, b ) = Po7::socketpair( Po7::af_unix, Po7::sock_stream | Po7::sock_cloexec, Po7::socket_protocol_t() );
+
+        Po7::unique_mapping m = Po7::mmap( 4096 );
+        std::fill( m->begin(), m->end(), 'm' );
+
+        std::size_t sent = Po7::send( *a, *m );
+        std::string received( 4096, ' ' );
+        std::size_t got = 0;
+        while ( got < sent )
+            got += Po7::recv( *b, &received[ got ], received.size() - got );
+
+        Check( sent == 4096 && received == std::string( 4096, 'm' ), "*unique_mapping is a buffer" );
+       }
+
+    void Loop()
+       {
+        Po7::unique_socket a, b;
+        std::tie( a, b ) = Po7::socketpair( Po7::af_unix, Po7::sock_stream | Po7::sock_nonblock | Po7::sock_cloexec, Po7::socket_protocol_t() );
+
+        Po7::socket_t  client = *a;
+        std::string    echoed;
+        Po7::event_loop loop;
+
+        // The server end echoes what it gets; the client end stops the loop when the echo comes back.
+        loop.add( std::move( b ), Po7::epollin, []( Po7::socket_t s, Po7::epoll_events_t )
+           {
+            char buffer[ 64 ];
+            Po7::try_result received = Po7::try_recv( s, buffer );
+            if ( !received.would_block() && received.size() != 0 )
+                Po7::send( s, buffer, received.size(), Po7::msg_nosignal );
+           } );
+
+        loop.add( std::move( a ), Po7::epollin, [&]( Po7::socket_t s, Po7::epoll_events_t )
+           {
+            char buffer[ 64 ];
+            Po7::try_result received = Po7::try_recv( s, buffer );
+            if ( !received.would_block() )
+                echoed.assign( buffer, received.size() );
+            loop.stop();
+           } );
+
+        Check( loop.size() == 2 && loop.contains( Po7::fd_t( Po7::Unwrap( client ) ) ), "event_loop registers both ends" );
+
+        Po7::send( client, std::string( "ping" ) );
+
+        for ( int round = 0; round < 10 && echoed.empty(); ++round )
+            loop.run_once( std::chrono::milliseconds( 100 ) );
+
+        Check( echoed == "ping", "event_loop carries a message both ways" );
+       }
+
+    std::string CurrentExceptionString()
+       {
+        try { throw; }
+        catch ( const std::exception& e )       { return e.what(); }
+        catch ( ... )                           { return "[unknown]"; }
+       }
+   }
+
+int main()
+   {
+    try
+       {
+        Handles();
+        Mapping();
+        Loop();
+
+        std::cout << std::flush;
+        return failed ? 1 : 0;
+       }
+    catch ( ... )
+       {
+        std::cerr << "Exiting with unknown exception: " << CurrentExceptionString() << std::endl;
+        return 1;
+       }
+   }
@@ -8,13 +8,26 @@
 
 #include "Po7_socket.h"
 #include "Po7_in.h"
+#include "Po7_event_loop.h"
+#include "Po7_sockopt.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <exception>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <arpa/inet.h>
 
 void GreetAndEcho( const std::string& greeting );
 void GreetAndEchoTheHardWay( const std::string& greeting );
+void GreetAndEchoMany( const std::string& greeting, std::size_t workers, Po7::in_port_t port );
 
 void GreetAndEcho( const std::string& greeting )
    {
@@ -116,6 +129,347 @@ void GreetAndEchoTheHardWay( const std::string& greeting )
        }
    }
 
+// GreetAndEchoMany is GreetAndEcho as a service: it greets any number of clients at once and echoes what
+// each sends back to it.  Every worker thread runs an event_loop with its own listening socket on the
+// shared port (SO_REUSEPORT), so the kernel spreads connections across them.  A worker that runs out of
+// descriptors or memory stops accepting for a moment, rather than failing.  Once a second it reports
+// connections and bytes per second.  On SIGINT or SIGTERM it stops accepting, gives open connections
+// a few seconds to finish, and returns.
+
+namespace
+   {
+    // Lock-free atomics are safe to set from a signal handler, and are seen by every worker.
+    std::atomic< bool > stopRequested( false );
+
+    extern "C" void RequestStop( int )
+       {
+        stopRequested = true;
+       }
+
+    struct EchoCounters
+       {
+        std::atomic< std::uint64_t > accepted{ 0 };
+        std::atomic< std::uint64_t > bytes{ 0 };
+        std::atomic< std::int64_t >  open{ 0 };
+       };
+
+    // Running out of descriptors or memory passes as connections close, but until it does accept fails at
+    // once, with the connection still waiting.
+    bool IsResourceExhaustion( const std::error_code& e )
+       {
+        return e == std::errc::too_many_files_open
+            || e == std::errc::too_many_files_open_in_system
+            || e == std::errc::no_buffer_space
+            || e == std::errc::not_enough_memory;
+       }
+
+    class EchoWorker
+       {
+        private:
+            struct connection
+               {
+                std::string  unsent;            // what the client hasn't taken yet: the greeting, or an echo
+                std::size_t  sent     = 0;
+                bool         finished = false;  // the client has sent everything it's going to
+               };
+
+            const std::string&          greeting;
+            EchoCounters&               counters;
+            Po7::event_loop             loop;
+            Po7::socket_t               listener;
+            std::vector< connection >   connections;    // indexed by descriptor, like the loop's own table
+
+            bool                                    acceptPaused = false;
+            std::chrono::milliseconds               acceptPause;
+            std::chrono::steady_clock::time_point   acceptResumes;
+
+            void Accept();
+            void PauseAccepting( const std::error_code& );
+            std::chrono::milliseconds NextWait( std::chrono::milliseconds poll ) const;
+            void Serve( Po7::socket_t );
+            bool Flush( Po7::socket_t, connection& );
+            void Close( Po7::socket_t );
+
+        public:
+            EchoWorker( Po7::unique_socket_in_domain< Po7::af_inet6 >, const std::string& greeting, EchoCounters& );
+
+            void Run( std::chrono::seconds drainTime );
+       };
+
+    const std::chrono::milliseconds shortestAcceptPause( 1 );
+    const std::chrono::milliseconds longestAcceptPause( 100 );
+
+    EchoWorker::EchoWorker( Po7::unique_socket_in_domain< Po7::af_inet6 > l, const std::string& g, EchoCounters& c )
+       : greeting( g ),
+         counters( c ),
+         listener( *l ),
+         acceptPause( shortestAcceptPause )
+       {
+        loop.add( std::move( l ), Po7::epollin, [this]( Po7::socket_t, Po7::epoll_events_t ) { Accept(); } );
+       }
+
+    // While accepting is paused, Run calls Accept again when the pause is over; the listener's events are
+    // ignored until then.
+    void EchoWorker::Accept()
+       {
+        if ( acceptPaused )
+            return;
+
+        for (;;)
+           {
+            Po7::unique_socket accepted;
+
+            try
+               {
+                accepted = Po7::try_accept( listener, Po7::sock_nonblock | Po7::sock_cloexec );
+               }
+            catch ( const std::system_error& error )
+               {
+                if ( error.code() == std::errc::connection_aborted || error.code() == std::errc::protocol_error )
+                    continue;
+                if ( !IsResourceExhaustion( error.code() ) )
+                    throw;
+
+                PauseAccepting( error.code() );
+                return;
+               }
+
+            if ( !accepted )
+                return;
+
+            acceptPause = shortestAcceptPause;
+
+            std::size_t index = static_cast< std::size_t >( Po7::Unwrap( *accepted ) );
+            if ( index >= connections.size() )
+                connections.resize( index + 1 );
+
+            connections[ index ] = connection();
+            connections[ index ].unsent = greeting;
+
+            loop.add( std::move( accepted ),
+                      Po7::epollin | Po7::epollout | Po7::epollrdhup,
+                      [this]( Po7::socket_t s, Po7::epoll_events_t ) { Serve( s ); } );
+
+            ++counters.accepted;
+            ++counters.open;
+           }
+       }
+
+    // The pause doubles each time accepting fails in a row, so a long shortage costs little, and is reported
+    // once when it starts.
+    void EchoWorker::PauseAccepting( const std::error_code& error )
+       {
+        if ( acceptPause == shortestAcceptPause )
+            std::cerr << "Pausing accept: " << error.message() << std::endl;
+
+        acceptPaused  = true;
+        acceptResumes = std::chrono::steady_clock::now() + acceptPause;
+        acceptPause   = std::min( acceptPause * 2, longestAcceptPause );
+       }
+
+    // NextWait is how long Run may wait for events: the poll interval, or less when accepting resumes sooner.
+    std::chrono::milliseconds EchoWorker::NextWait( std::chrono::milliseconds poll ) const
+       {
+        if ( !acceptPaused )
+            return poll;
+
+        auto now = std::chrono::steady_clock::now();
+        if ( acceptResumes <= now )
+            return std::chrono::milliseconds( 0 );
+
+        return std::min( poll, std::chrono::duration_cast< std::chrono::milliseconds >( acceptResumes - now ) + std::chrono::milliseconds( 1 ) );
+       }
+
+    // Flush sends what's waiting, and says whether it all went.
+    bool EchoWorker::Flush( Po7::socket_t s, connection& c )
+       {
+        while ( c.sent < c.unsent.size() )
+           {
+            Po7::try_result result = Po7::try_send( s, c.unsent.data() + c.sent, c.unsent.size() - c.sent, Po7::msg_nosignal );
+            if ( result.would_block() )
+                return false;
+            c.sent += result.size();
+           }
+
+        c.unsent.clear();
+        c.sent = 0;
+        return true;
+       }
+
+    // Serve runs until the socket would block.  While an echo is waiting to go out, it stops reading,
+    // so a client that doesn't read can't make the server buffer without limit.
+    void EchoWorker::Serve( Po7::socket_t s )
+       {
+        connection& c = connections[ static_cast< std::size_t >( Po7::Unwrap( s ) ) ];
+        char buffer[ 16384 ];
+
+        try
+           {
+            for (;;)
+               {
+                if ( !Flush( s, c ) )
+                    return;
+
+                if ( c.finished )
+                   {
+                    Close( s );
+                    return;
+                   }
+
+                Po7::try_result received = Po7::try_recv( s, buffer );
+                if ( received.would_block() )
+                    return;
+
+                if ( received.size() == 0 )
+                   {
+                    c.finished = true;
+                    continue;
+                   }
+
+                counters.bytes += received.size();
+
+                Po7::try_result echoed = Po7::try_send( s, buffer, received.size(), Po7::msg_nosignal );
+                std::size_t sent = echoed.would_block() ? 0 : echoed.size();
+                c.unsent.assign( buffer + sent, received.size() - sent );
+               }
+           }
+        catch ( const std::system_error& )
+           {
+            Close( s );         // a reset or similar; the client is gone
+           }
+       }
+
+    void EchoWorker::Close( Po7::socket_t s )
+       {
+        connections[ static_cast< std::size_t >( Po7::Unwrap( s ) ) ] = connection();
+        loop.close( s );
+        --counters.open;
+       }
+
+    void EchoWorker::Run( std::chrono::seconds drainTime )
+       {
+        const std::chrono::milliseconds poll( 100 );
+
+        while ( !stopRequested )
+           {
+            loop.run_once( NextWait( poll ) );
+
+            if ( acceptPaused && std::chrono::steady_clock::now() >= acceptResumes )
+               {
+                acceptPaused = false;
+                Accept();
+               }
+           }
+
+        loop.close( listener );
+
+        auto deadline = std::chrono::steady_clock::now() + drainTime;
+        while ( loop.size() != 0 && std::chrono::steady_clock::now() < deadline )
+            loop.run_once( poll );
+
+        // Connections still open after the drain are closed with the loop.
+        counters.open -= static_cast< std::int64_t >( loop.size() );
+       }
+
+    // The first listener picks the port if it's zero; the rest join it.
+    std::vector< Po7::unique_socket_in_domain< Po7::af_inet6 > > OpenListeners( Po7::in_port_t port, std::size_t count )
+       {
+        std::vector< Po7::unique_socket_in_domain< Po7::af_inet6 > > listeners;
+        sockaddr_in6 address = Po7::Make< sockaddr_in6 >( in6addr_any, port );
+
+        for ( std::size_t i = 0; i < count; ++i )
+           {
+            auto listener = Po7::socket< Po7::af_inet6 >( Po7::sock_stream | Po7::sock_nonblock | Po7::sock_cloexec, Po7::socket_protocol_t() );
+            Po7::setsockopt< Po7::so_reuseport >( *listener, true );
+            Po7::bind( *listener, address );
+            Po7::listen( *listener, SOMAXCONN );
+
+            if ( i == 0 )
+                address = Po7::getsockname( *listener );
+
+            listeners.push_back( std::move( listener ) );
+           }
+
+        return listeners;
+       }
+   }
+
+void GreetAndEchoMany( const std::string& greeting, std::size_t workers, Po7::in_port_t port )
+   {
+    if ( workers == 0 )
+        throw std::invalid_argument( "GreetAndEchoMany needs at least one worker" );
+
+    std::signal( SIGINT,  RequestStop );
+    std::signal( SIGTERM, RequestStop );
+    std::signal( SIGPIPE, SIG_IGN );
+
+    auto listeners = OpenListeners( port, workers );
+    sockaddr_in6 bound = Po7::getsockname( *listeners.front() );
+
+    // The listeners take any address; clients on this machine can reach them over loopback.
+    sockaddr_in6 loopback = bound;
+    loopback.sin6_addr = in6addr_loopback;
+
+    std::cout << "Listening on " << Po7::Make< std::string >( bound )
+              << " with " << workers << " workers; connect to " << Po7::Make< std::string >( loopback ) << std::endl;
+
+    EchoCounters                counters;
+    std::vector< std::thread >  threads;
+    std::exception_ptr          failure;
+    std::atomic< bool >         failed( false );
+
+    for ( auto& listener : listeners )
+        threads.emplace_back( [&greeting, &counters, &failure, &failed]( Po7::unique_socket_in_domain< Po7::af_inet6 > l )
+                                 {
+                                  try
+                                     {
+                                      EchoWorker( std::move( l ), greeting, counters ).Run( std::chrono::seconds( 5 ) );
+                                     }
+                                  catch ( ... )
+                                     {
+                                      if ( !failed.exchange( true ) )
+                                          failure = std::current_exception();
+                                      stopRequested = true;
+                                     }
+                                 },
+                              std::move( listener ) );
+
+    std::uint64_t lastAccepted = 0;
+    std::uint64_t lastBytes    = 0;
+    auto          lastReport   = std::chrono::steady_clock::now();
+
+    while ( !stopRequested )
+       {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+
+        auto now = std::chrono::steady_clock::now();
+        if ( now - lastReport < std::chrono::seconds( 1 ) )
+            continue;
+
+        double        seconds  = std::chrono::duration< double >( now - lastReport ).count();
+        std::uint64_t accepted = counters.accepted;
+        std::uint64_t bytes    = counters.bytes;
+
+        std::cout << ( accepted - lastAccepted ) / seconds << " connections/s, "
+                  << ( bytes - lastBytes ) / seconds << " bytes/s, "
+                  << counters.open << " open" << std::endl;
+
+        lastAccepted = accepted;
+        lastBytes    = bytes;
+        lastReport   = now;
+       }
+
+    std::cout << "Draining " << counters.open << " connections" << std::endl;
+
+    for ( std::thread& t : threads )
+        t.join();
+
+    std::cout << "Served " << counters.accepted << " connections and " << counters.bytes << " bytes\n";
+
+    if ( failure )
+        std::rethrow_exception( failure );
+   }
+
 static std::string CurrentExceptionString()
    {
     try { throw; }
@@ -123,10 +477,28 @@ static std::string CurrentExceptionString()
     catch ( ... )                           { return "[unknown]"; }
    }
 
-int main()
+// With no arguments, main greets and echoes one client; "hardway" does the same with GreetAndEchoTheHardWay.
+// "serve [workers [port]]" runs GreetAndEchoMany, with a worker per core and a port chosen by the system
+// unless they're given.
+int main( int argc, char *argv[] )
    {
     try
        {
+        if ( argc > 1 && std::string( argv[1] ) == "serve" )
+           {
+            std::size_t workers = argc > 2 ? std::stoul( argv[2] ) : std::max( 1u, std::thread::hardware_concurrency() );
+            Po7::in_port_t port = argc > 3 ? Po7::Make< Po7::in_port_t >( std::string( argv[3] ) ) : Po7::in_port_t();
+
+            GreetAndEchoMany( "Hello, world!\n", workers, port );
+            return 0;
+           }
+
+        if ( argc > 1 && std::string( argv[1] ) == "hardway" )
+           {
+            GreetAndEchoTheHardWay( "Hello, world!\n" );
+            return 0;
+           }
+
         GreetAndEcho( "Hello, world!\n" );
         return 0;
        }